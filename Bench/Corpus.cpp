@@ -0,0 +1,146 @@
+#include "Corpus.h"
+
+/**
+ * Next pseudo random number (splitmix64)
+ */
+uint64_t Corpus::next() {
+    uint64_t z = (_state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+std::string Corpus::word() {
+    static const char* words[] = {
+        "glider", "cannon", "pulsar", "beacon", "toad", "blinker", "loaf", "boat",
+        "spaceship", "puffer", "breeder", "eater", "oscillator", "still", "life", "gun"
+    };
+    return words[below(16)];
+}
+
+/**
+ * Records nested 48 levels down, even levels
+ * are objects and odd levels are arrays
+ */
+std::string Corpus::deep(size_t size) {
+    std::string text = "[";
+
+    for (int record = 0; text.size() < size; record++) {
+        if (record) text += ",";
+
+        for (int level = 0; level < 48; level++)
+            text += level % 2 ? "[" + std::to_string(level) + "," : "{\"level\":" + std::to_string(level) + ",\"child\":";
+
+        text += "\"" + word() + "\"";
+
+        for (int level = 47; level >= 0; level--)
+            text += level % 2 ? "]" : "}";
+    }
+
+    return text + "]";
+}
+
+std::string Corpus::wide(size_t size) {
+    std::string text = "[";
+
+    for (int record = 0; text.size() < size; record++) {
+        if (record) text += ",";
+        text += "{";
+
+        for (int member = 0; member < WIDE_MEMBERS; member++) {
+            if (member) text += ",";
+            text += "\"field" + std::to_string(member) + "\":";
+
+            switch (member % 4) {
+                case 0: text += std::to_string(below(1000000)); break;
+                case 1: text += "\"" + word() + "\""; break;
+                case 2: text += below(2) ? "true" : "false"; break;
+                case 3: text += "null"; break;
+            }
+        }
+
+        text += "}";
+    }
+
+    return text + "]";
+}
+
+/**
+ * Figures with a name, a dimension and ranges of 4 ints,
+ * plus a weight per range (floats)
+ */
+std::string Corpus::numbers(size_t size) {
+    std::string text = "[";
+
+    for (int figure = 0; text.size() < size; figure++) {
+        if (figure) text += ",";
+
+        text += "{\"name\":\"" + word() + "-" + std::to_string(figure) + "\",";
+        text += "\"dimension\":{\"width\":" + std::to_string(below(100)) + ",\"height\":" + std::to_string(below(100)) + "},";
+        text += "\"ranges\":[";
+
+        size_t ranges = 10 + below(20);
+        for (size_t i = 0; i < ranges; i++) {
+            if (i) text += ",";
+            text += "[" + std::to_string(below(64)) + "," + std::to_string(below(64)) + "," +
+                std::to_string(below(8)) + "," + std::to_string(below(8)) + "]";
+        }
+
+        text += "],\"weights\":[";
+        for (size_t i = 0; i < ranges; i++) {
+            if (i) text += ",";
+            text += std::to_string(below(1000000) / 1000.0).substr(0, 7);
+        }
+        text += "]}";
+    }
+
+    return text + "]";
+}
+
+std::string Corpus::strings(size_t size) {
+    static const char* pieces[] = { " ", "\\\"", "\\\\", "\\n", "\\t", "\\u00e9", "\\u4e2d", "/" };
+    std::string text = "[";
+
+    for (int record = 0; text.size() < size; record++) {
+        if (record) text += ",";
+        text += "{\"title\":\"";
+
+        size_t words = 1 + below(6);
+        for (size_t i = 0; i < words; i++)
+            text += word() + (below(4) ? " " : pieces[below(8)]);
+
+        text += "\",\"body\":\"";
+
+        words = 20 + below(80);
+        for (size_t i = 0; i < words; i++)
+            text += word() + (below(8) ? " " : pieces[below(8)]);
+
+        text += "\"}";
+    }
+
+    return text + "]";
+}
+
+std::string Corpus::ndjson(size_t size) {
+    std::string text;
+
+    for (int record = 0; text.size() < size; record++) {
+        text += "{\"id\":" + std::to_string(record) + ",\"kind\":\"" + word() + "\",\"score\":" +
+            std::to_string(below(100000)) + ",\"tags\":[\"" + word() + "\",\"" + word() + "\"]}\n";
+    }
+
+    return text;
+}
+
+std::vector<std::string> Corpus::Names() {
+    return { "deep", "wide", "numbers", "strings", "ndjson" };
+}
+
+std::string Corpus::generate(const std::string& name, size_t size) {
+    if (name == "deep") return deep(size);
+    if (name == "wide") return wide(size);
+    if (name == "numbers") return numbers(size);
+    if (name == "strings") return strings(size);
+    if (name == "ndjson") return ndjson(size);
+    return "";
+}
@@ -0,0 +1,64 @@
+#ifndef CORPUS_API
+#define CORPUS_API
+
+/**
+ * Libraries
+ */
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Synthetic json documents for the benchmarks
+ *
+ * Every generator is deterministic (same seed, same text) and
+ * appends values until the document reaches about <size> bytes:
+ * - deep: records nested 48 levels down through objects and arrays
+ * - wide: objects of 200 members
+ * - numbers: figures like static/figure.json, arrays of ints and floats
+ * - strings: string members with escapes and unicode
+ * - ndjson: one small record per line
+ */
+class Corpus {
+
+    uint64_t _state;
+
+    /**
+     * Next pseudo random number (splitmix64)
+     */
+    uint64_t next();
+
+    /**
+     * A random number in [0, limit)
+     */
+    uint64_t below(uint64_t limit) { return next() % limit; }
+
+    std::string word();
+
+    public: /********* Public members *********/
+
+    /**
+     * Members of the objects of the wide corpus
+     */
+    static const int WIDE_MEMBERS = 200;
+
+    Corpus(uint64_t seed = 12343) :_state(seed) {}
+
+    std::string deep(size_t size);
+    std::string wide(size_t size);
+    std::string numbers(size_t size);
+    std::string strings(size_t size);
+    std::string ndjson(size_t size);
+
+    /**
+     * Names of the corpora
+     */
+    static std::vector<std::string> Names();
+
+    /**
+     * The corpus called <name>, empty for an unknown name
+     */
+    std::string generate(const std::string& name, size_t size);
+};
+
+#endif
@@ -0,0 +1,339 @@
+#include "../Json/Json.h"
+#include "../Json/JsonBinding.h"
+#include "../Json/JsonPath.h"
+#include "../Json/JsonSnapshot.h"
+#include "./Corpus.h"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace JsonSer;
+
+/**
+ * Counts the allocations of the program and their bytes, every
+ * replaceable form of new and delete is replaced (so that they all match)
+ */
+static atomic<size_t> allocations(0);
+static atomic<size_t> allocatedBytes(0);
+
+static void* allocate(size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    allocatedBytes.fetch_add(size, memory_order_relaxed);
+    if (void* memory = malloc(size ? size : 1))
+        return memory;
+    throw bad_alloc();
+}
+static void deallocate(void* memory) noexcept { free(memory); }
+
+/**
+ * Over-aligned memory is taken from a bigger block,
+ * the block is kept right before the memory
+ */
+static void* allocate(size_t size, align_val_t alignment) {
+    uintptr_t mask = (uintptr_t)alignment - 1;
+    char* block = (char*)allocate(size + (size_t)mask + sizeof(void*));
+    void** memory = (void**)(((uintptr_t)block + sizeof(void*) + mask) & ~mask);
+    memory[-1] = block;
+    return memory;
+}
+static void deallocate(void* memory, align_val_t) noexcept {
+    if (memory)
+        free(((void**)memory)[-1]);
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, align_val_t alignment) { return allocate(size, alignment); }
+void* operator new[](size_t size, align_val_t alignment) { return allocate(size, alignment); }
+
+void operator delete(void* memory) noexcept { deallocate(memory); }
+void operator delete[](void* memory) noexcept { deallocate(memory); }
+void operator delete(void* memory, size_t) noexcept { deallocate(memory); }
+void operator delete[](void* memory, size_t) noexcept { deallocate(memory); }
+void operator delete(void* memory, align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete[](void* memory, align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete(void* memory, size_t, align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete[](void* memory, size_t, align_val_t alignment) noexcept { deallocate(memory, alignment); }
+
+/**
+ * Best time of <repeat> runs of <task> in seconds
+ */
+static double best(int repeat, const function<void()>& task) {
+    double fastest = numeric_limits<double>::max();
+
+    for (int i = 0; i < repeat; i++) {
+        auto start = chrono::steady_clock::now();
+        task();
+        fastest = min(fastest, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    return fastest;
+}
+
+static double rounded(double value) {
+    return round(value * 100) / 100;
+}
+
+/**
+ * The lookup of each corpus in one of its documents, it returns
+ * something that depends on the result so that the lookup can't
+ * be left out
+ */
+typedef long long (*Lookup)(Json& document, size_t i);
+
+static Lookup lookupOf(const string& corpus) {
+    static vector<string> fields = [] {
+        vector<string> names;
+        for (int i = 0; i < Corpus::WIDE_MEMBERS; i++)
+            names.push_back("field" + to_string(i));
+        return names;
+    }();
+    static const string level = "level", child = "child", ranges = "ranges", title = "title", kind = "kind";
+
+    if (corpus == "deep")
+        return [](Json& document, size_t) { return (long long)document[child][1][child][1][child][1][level]; };
+    if (corpus == "wide")
+        return [](Json& document, size_t i) { return (long long)(&document[fields[(i * 4) % Corpus::WIDE_MEMBERS]] != &document); };
+    if (corpus == "numbers")
+        return [](Json& document, size_t i) { return (long long)document[ranges][(int)(i % 10)][2]; };
+    if (corpus == "strings")
+        return [](Json& document, size_t) { return (long long)(&document[title] != &document); };
+    return [](Json& document, size_t) { return (long long)(&document[kind] != &document); };
+}
+
+/**
+ * Structs of the numbers and ndjson corpora, they are read and
+ * written without a Json tree (JSON_FIELDS) for the bind_* results
+ */
+struct Dimension {
+    int width = 0;
+    int height = 0;
+};
+JSON_FIELDS(Dimension, width, height)
+
+struct Figure {
+    string name;
+    Dimension dimension;
+    vector<vector<int>> ranges;
+    vector<double> weights;
+};
+JSON_FIELDS(Figure, name, dimension, ranges, weights)
+
+struct Event {
+    long long id = 0;
+    string kind;
+    long long score = 0;
+    vector<string> tags;
+};
+JSON_FIELDS(Event, id, kind, score, tags)
+
+/**
+ * Times of reading the corpus into structs and of writing them back,
+ * the records of <lines> are read and written one by one
+ */
+template<class T>
+static void bindCorpus(const string& text, bool lines, int repeat, double& readTime, double& writeTime) {
+    vector<T> values;
+    vector<string_view> records;
+
+    if (lines) {
+        for (size_t start = 0, end; start < text.size(); start = end + 1) {
+            end = text.find('\n', start);
+            if (end == string::npos) end = text.size();
+            if (end > start) records.push_back(string_view(text).substr(start, end - start));
+        }
+    }
+
+    readTime = best(repeat, [&] {
+        values.clear();
+        if (!lines) {
+            JsonStruct::fromString(text, values);
+            return;
+        }
+        values.resize(records.size());
+        for (size_t i = 0; i < records.size(); i++)
+            JsonStruct::fromString(records[i], values[i]);
+    });
+
+    writeTime = best(repeat, [&] {
+        string out;
+        if (!lines)
+            out = JsonStruct::toString(values);
+        else
+            for (const T& value : values) {
+                out += JsonStruct::toString(value);
+                out += '\n';
+            }
+    });
+}
+
+/**
+ * Times of a cold start: loading the corpus and reading one member of
+ * its first document, from the json text (in memory and in a file) and
+ * from its snapshot file. The files are written to the temporary
+ * directory and removed, they are read from a warm page cache. It
+ * returns something that depends on the members read
+ */
+static long long coldStart(const string& name, const string& text, const Json& json, int repeat,
+    double& stringTime, double& fileTime, double& snapshotTime, size_t& snapshotBytes) {
+
+    const filesystem::path directory = filesystem::temp_directory_path();
+    const string textPath = (directory / ("bench_" + name + ".json")).string();
+    const string snapshotPath = (directory / ("bench_" + name + ".jsnp")).string();
+
+    ofstream(textPath, ios::binary) << text;
+    JsonSnapshot::save(json, snapshotPath);
+    snapshotBytes = filesystem::file_size(snapshotPath);
+
+    string key(JsonSnapshot(snapshotPath).root()[0].key(0));
+    long long sink = 0;
+
+    stringTime = best(repeat, [&] {
+        Json loaded = Json::fromString(text);
+        sink += (long long)loaded[0][key].toString().size();
+    });
+    fileTime = best(repeat, [&] {
+        Json loaded = Json::fromFile(textPath);
+        sink += (long long)loaded[0][key].toString().size();
+    });
+    snapshotTime = best(repeat, [&] {
+        JsonSnapshot snapshot(snapshotPath);
+        sink += (long long)snapshot.root()[0][key].type();
+    });
+
+    filesystem::remove(textPath);
+    filesystem::remove(snapshotPath);
+    return sink;
+}
+
+/**
+ * Usage: bench [--size MB] [--repeat N] [--lookups N] [--revision label] [corpus...]
+ *
+ * Prints a json line per corpus:
+ * {"revision", "corpus", "bytes", "documents", "parse_mb_s", "write_mb_s",
+ *  "lookup_ns", "allocations_per_document", "allocated_bytes_per_document",
+ *  "bind_mb_s", "bind_write_mb_s", "from_string_us", "from_file_us",
+ *  "snapshot_open_us", "snapshot_bytes"}
+ * documents are the elements of the top level array (the lines for ndjson),
+ * the bind_* results are null for the corpora without structs and the
+ * cold start ones (*_us, snapshot_bytes) for ndjson, which isn't one document
+ */
+int main(int argc, char** argv) {
+    size_t size = 16;
+    int repeat = 5;
+    size_t lookups = 1000000;
+    string revision = "local";
+    vector<string> corpora;
+
+    for (int i = 1; i < argc; i++) {
+        string argument = argv[i];
+
+        if (argument == "--size" && i + 1 < argc) size = stoul(argv[++i]);
+        else if (argument == "--repeat" && i + 1 < argc) repeat = stoi(argv[++i]);
+        else if (argument == "--lookups" && i + 1 < argc) lookups = stoul(argv[++i]);
+        else if (argument == "--revision" && i + 1 < argc) revision = argv[++i];
+        else corpora.push_back(argument);
+    }
+
+    if (corpora.empty())
+        corpora = Corpus::Names();
+
+    for (const string& name : corpora) {
+        string text = Corpus().generate(name, size << 20);
+        if (text.empty()) {
+            cerr << "Unknown corpus '" << name << "'\n";
+            return 1;
+        }
+
+        bool lines = name == "ndjson";
+        vector<Json*> documents;
+        vector<Json::Record> records;
+        Json json;
+
+        /**
+         * Parsing, the allocations are the ones of the last run
+         */
+        size_t allocationsBefore = 0, bytesBefore = 0;
+        double parseTime = best(repeat, [&] {
+            json = Json();
+            records.clear();
+            allocationsBefore = allocations;
+            bytesBefore = allocatedBytes;
+
+            if (lines)
+                records = Json::parseMany(text);
+            else
+                json = Json::fromString(text);
+        });
+        size_t parseAllocations = allocations - allocationsBefore;
+        size_t parseBytes = allocatedBytes - bytesBefore;
+
+        if (lines)
+            for (auto& record : records) documents.push_back(&record.value);
+        else
+            JsonPath("$[*]").findAll(json, documents);
+
+        /**
+         * Writing
+         */
+        size_t written = 0;
+        double writeTime = best(repeat, [&] {
+            written = 0;
+            if (lines)
+                for (Json* document : documents) written += document->toString().size() + 1;
+            else
+                written = json.toString().size();
+        });
+
+        /**
+         * Lookups
+         */
+        Lookup lookup = lookupOf(name);
+        long long sink = 0;
+        double lookupTime = documents.empty() ? 0 : best(repeat, [&] {
+            for (size_t i = 0; i < lookups; i++)
+                sink += lookup(*documents[(i * 7919) % documents.size()], i);
+        });
+
+        /**
+         * Structs instead of the tree
+         */
+        double bindTime = 0, bindWriteTime = 0;
+        if (name == "numbers")
+            bindCorpus<Figure>(text, false, repeat, bindTime, bindWriteTime);
+        else if (lines)
+            bindCorpus<Event>(text, true, repeat, bindTime, bindWriteTime);
+
+        /**
+         * Cold start
+         */
+        double stringTime = 0, fileTime = 0, snapshotTime = 0;
+        size_t snapshotBytes = 0;
+        if (!lines)
+            sink += coldStart(name, text, json, repeat, stringTime, fileTime, snapshotTime, snapshotBytes);
+
+        auto microseconds = [&](double time) { return lines ? Json(nullptr) : Json(rounded(time * 1e6)); };
+
+        size_t count = max<size_t>(documents.size(), 1);
+
+        Json::Object result;
+        result.try_emplace("revision", Json(revision));
+        result.try_emplace("corpus", Json(name));
+        result.try_emplace("bytes", Json((long long)text.size()));
+        result.try_emplace("documents", Json((long long)documents.size()));
+        result.try_emplace("parse_mb_s", Json(rounded(text.size() / parseTime / (1 << 20))));
+        result.try_emplace("write_mb_s", Json(rounded(written / writeTime / (1 << 20))));
+        result.try_emplace("lookup_ns", Json(rounded(lookupTime * 1e9 / max<size_t>(lookups, 1))));
+        result.try_emplace("allocations_per_document", Json(rounded((double)parseAllocations / count)));
+        result.try_emplace("allocated_bytes_per_document", Json(rounded((double)parseBytes / count)));
+        result.try_emplace("bind_mb_s", bindTime ? Json(rounded(text.size() / bindTime / (1 << 20))) : Json(nullptr));
+        result.try_emplace("bind_write_mb_s", bindWriteTime ? Json(rounded(written / bindWriteTime / (1 << 20))) : Json(nullptr));
+        result.try_emplace("from_string_us", microseconds(stringTime));
+        result.try_emplace("from_file_us", microseconds(fileTime));
+        result.try_emplace("snapshot_open_us", microseconds(snapshotTime));
+        result.try_emplace("snapshot_bytes", lines ? Json(nullptr) : Json((long long)snapshotBytes));
+
+        cout << Json(std::move(result)).toString() << (sink == 42 ? " " : "") << endl;
+    }
+
+    return 0;
+}
@@ -1,10 +1,10 @@
-
-#include <windows.h>
 #include "./Console.h"
 
+#ifdef _WIN32
+#include <windows.h>
 
 /**
- * Setting a console color 
+ * Setting a console color
  */
 void SetConsoleColor(ConsoleColor color)
 {
@@ -17,5 +17,36 @@ void SetConsoleColor(ConsoleColor color)
  */
 void ResetConsole()
 {
-    SetConsoleColor(ConsoleColor::White); 
-}
\ No newline at end of file
+    SetConsoleColor(ConsoleColor::White);
+}
+
+#else
+#include <iostream>
+#include <unistd.h>
+
+/**
+ * ANSI foreground of each console color (the console
+ * colors are BGR bits, the ANSI ones RGB), colors are
+ * only written to a terminal
+ */
+static const int ansiColors[] = { 30, 34, 32, 36, 31, 35, 33, 37, 90, 94, 92, 96, 91, 95, 93, 97 };
+
+/**
+ * Setting a console color
+ */
+void SetConsoleColor(ConsoleColor color)
+{
+    if (isatty(STDOUT_FILENO))
+        std::cout << "\033[" << ansiColors[(int)color] << "m";
+}
+
+/**
+ * Resetting the default console color
+ */
+void ResetConsole()
+{
+    if (isatty(STDOUT_FILENO))
+        std::cout << "\033[0m";
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "AccountingResource.h"
+
+#include <new>
+
+namespace JsonSer
+{
+
+    /************************** Accounting Resource **************************/
+
+    AccountingResource::AccountingResource(size_t budget, pmr::memory_resource* upstream)
+        :_upstream(upstream), _budget(budget), _live(0), _peak(0), _allocations(0), _deallocations(0) { }
+
+    /**
+     * The bytes are counted before they are allocated,
+     * so that concurrent allocations can't all pass the budget
+     */
+    void* AccountingResource::do_allocate(size_t bytes, size_t alignment) {
+        size_t live = _live.fetch_add(bytes, memory_order_relaxed) + bytes;
+
+        if (live > _budget || live < bytes) {
+            _live.fetch_sub(bytes, memory_order_relaxed);
+            throw bad_alloc();
+        }
+
+        void* memory;
+        try {
+            memory = _upstream->allocate(bytes, alignment);
+        }
+        catch (...) {
+            _live.fetch_sub(bytes, memory_order_relaxed);
+            throw;
+        }
+
+        size_t peak = _peak.load(memory_order_relaxed);
+        while (live > peak && !_peak.compare_exchange_weak(peak, live, memory_order_relaxed));
+
+        _allocations.fetch_add(1, memory_order_relaxed);
+        return memory;
+    }
+
+    void AccountingResource::do_deallocate(void* memory, size_t bytes, size_t alignment) {
+        _upstream->deallocate(memory, bytes, alignment);
+        _live.fetch_sub(bytes, memory_order_relaxed);
+        _deallocations.fetch_add(1, memory_order_relaxed);
+    }
+
+    bool AccountingResource::do_is_equal(const pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+    Json AccountingResource::toJson() const {
+        Json::Object report;
+        report.try_emplace("live", Json((long long)live()));
+        report.try_emplace("peak", Json((long long)peak()));
+        report.try_emplace("allocations", Json((long long)allocations()));
+        report.try_emplace("deallocations", Json((long long)deallocations()));
+        report.try_emplace("budget", _budget == UNLIMITED ? Json(nullptr) : Json((long long)_budget));
+        return Json(std::move(report));
+    }
+
+} // namespace JsonSer
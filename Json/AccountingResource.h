@@ -0,0 +1,81 @@
+#ifndef ACCOUNTING_RESOURCE_API
+#define ACCOUNTING_RESOURCE_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+
+#include <atomic>
+#include <memory_resource>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A memory resource that counts what the documents allocated from it
+     * hold: the live and peak bytes and the number of allocations
+     *
+     * The memory comes from the <upstream> resource. An allocation that
+     * would take the live bytes over the budget throws bad_alloc (the
+     * parsing throws it too), the resource must outlive the values
+     * allocated from it. The counters are atomic, so one resource
+     * can be used by the parallel parsers
+     *
+     *     AccountingResource memory(64 << 20);
+     *     Json::ParseOptions options;
+     *     options.resource = &memory;
+     *     Json request = Json::fromString(body, options);
+     */
+    class AccountingResource : public pmr::memory_resource {
+
+        pmr::memory_resource* _upstream;
+        size_t _budget;
+
+        atomic<size_t> _live;
+        atomic<size_t> _peak;
+        atomic<size_t> _allocations;
+        atomic<size_t> _deallocations;
+
+        protected: /**************** memory resource ****************/
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* memory, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override;
+
+        public: /**************** public members ****************/
+
+        static const size_t UNLIMITED = (size_t)-1;
+
+        explicit AccountingResource(size_t budget = UNLIMITED, pmr::memory_resource* upstream = Json::heap());
+
+        AccountingResource(const AccountingResource&) = delete;
+        AccountingResource& operator=(const AccountingResource&) = delete;
+
+        /**
+         * Bytes allocated and not freed yet, and their highest value
+         */
+        size_t live() const { return _live.load(memory_order_relaxed); }
+        size_t peak() const { return _peak.load(memory_order_relaxed); }
+
+        size_t allocations() const { return _allocations.load(memory_order_relaxed); }
+        size_t deallocations() const { return _deallocations.load(memory_order_relaxed); }
+
+        size_t budget() const { return _budget; }
+
+        /**
+         * The peak starts again from the live bytes
+         */
+        void resetPeak() { _peak.store(live(), memory_order_relaxed); }
+
+        /**
+         * {"live", "peak", "allocations", "deallocations", "budget"}
+         * (the budget is null when unlimited)
+         */
+        Json toJson() const;
+    };
+
+} // namespace JsonSer
+
+#endif
@@ -1,4 +1,9 @@
 #include "Json.h"
+#include "JsonBinary.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
 
 namespace JsonSer
 {
@@ -6,7 +11,7 @@ namespace JsonSer
     /************************** Json Reporter **************************/
 
     void Json::Reporter::ReportUnexpectedChar(
-        const char& current, const int& position, const char& expected, const string& additional
+        const char& current, const size_t& position, const char& expected, const string& additional
     ){
         string diagnostic = "Unexpected char '";
         diagnostic.push_back(current);
@@ -19,349 +24,882 @@ namespace JsonSer
         _diagnostics.push_back(diagnostic);
     }
 
+    void Json::Reporter::ReportUnreadableFile(const string& path) {
+        _diagnostics.push_back("Unable to read file '" + path + "'");
+    }
+
+    void Json::Reporter::ReportUnexpectedByte(const uint8_t& current, const size_t& position, const string& additional) {
+        static const char digits[] = "0123456789abcdef";
+
+        string diagnostic = "Unexpected byte 0x";
+        diagnostic.push_back(digits[current >> 4]);
+        diagnostic.push_back(digits[current & 15]);
+        diagnostic += " at position <" + to_string(position) + ">";
+        if(additional != "") diagnostic += " >>> " + additional + " <<<";
+        _diagnostics.push_back(diagnostic);
+    }
+
+    void Json::Reporter::ReportUnexpectedEnd(const size_t& position, const string& additional) {
+        string diagnostic = "Unexpected end at position <" + to_string(position) + ">";
+        if(additional != "") diagnostic += " >>> " + additional + " <<<";
+        _diagnostics.push_back(diagnostic);
+    }
+
+    void Json::Reporter::ReportInvalidValue(const size_t& position, const string& path, const string& additional) {
+        string diagnostic = "Invalid value at position <" + to_string(position) + "> (" + path + ")";
+        if(additional != "") diagnostic += " >>> " + additional + " <<<";
+        _diagnostics.push_back(diagnostic);
+    }
+
+    void Json::Reporter::ReportInvalidSchema(const string& path, const string& additional) {
+        string diagnostic = "Invalid schema at " + path;
+        if(additional != "") diagnostic += " >>> " + additional + " <<<";
+        _diagnostics.push_back(diagnostic);
+    }
+
     
-    /************************** Json Parser **************************/
+    /************************** Json Key ********************************/
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "Json::Key tells inline keys from pointers by the first byte of its handle"
+#endif
+
+    Json::Key::Data* Json::Key::create(string_view text, pmr::memory_resource* resource) {
+        size_t prefix = resource == Json::heap() ? 0 : RESOURCE_PREFIX;
+
+        char* memory = (char*)resource->allocate(prefix + offsetof(Data, _text) + text.size(), alignof(Data));
+        if (prefix)
+            memcpy(memory, &resource, sizeof(resource));
+
+        Data* data = new (memory + prefix) Data;
+        data->_references.store(1, memory_order_relaxed);
+        data->_length = (uint32_t)text.size() | (prefix ? OWN_RESOURCE : 0);
+        data->_hash = hashOf(text);
+        memcpy(data->_text, text.data(), text.size());
+        return data;
+    }
+
+    void Json::Key::release() {
+        Data* data = this->data();
+
+        if (data && data->_references.fetch_sub(1, memory_order_acq_rel) == 1) {
+            pmr::memory_resource* resource = Json::heap();
+            size_t prefix = 0;
+
+            if (data->_length & OWN_RESOURCE) {
+                prefix = RESOURCE_PREFIX;
+                memcpy(&resource, (char*)data - prefix, sizeof(resource));
+            }
+
+            size_t size = prefix + offsetof(Data, _text) + (data->_length & ~OWN_RESOURCE);
+            data->~Data();
+            resource->deallocate((char*)data - prefix, size, alignof(Data));
+        }
+        memset(_handle, 0, sizeof(_handle));
+    }
+
+    Json::Key::Key(string_view text, pmr::memory_resource* resource)
+        :_handle()
+    {
+        if (text.empty())
+            return;
+
+        if (text.size() <= INLINE_KEY) {
+            _handle[0] = (char)(text.size() << 1 | 1);
+            memcpy(_handle + 1, text.data(), text.size());
+            return;
+        }
+
+        Data* data = create(text, resource);
+        memcpy(_handle, &data, sizeof(data));
+    }
+
+    Json::Key::Key(const Key& other)
+    {
+        memcpy(_handle, other._handle, sizeof(_handle));
+        if (Data* data = this->data())
+            data->_references.fetch_add(1, memory_order_relaxed);
+    }
+
+    Json::Key& Json::Key::operator=(const Key& other) {
+        if (Data* data = other.data())
+            data->_references.fetch_add(1, memory_order_relaxed);
+        release();
+        memcpy(_handle, other._handle, sizeof(_handle));
+        return *this;
+    }
+
+    Json::Key& Json::Key::operator=(Key&& other) noexcept {
+        if (this != &other) {
+            release();
+            memcpy(_handle, other._handle, sizeof(_handle));
+            memset(other._handle, 0, sizeof(other._handle));
+        }
+        return *this;
+    }
 
-    /**
-     * Default constructor 
-     */
-    Json::JsonParser::JsonParser(const string& text) 
-        :_text(text) { }
 
-    Json::JsonParser::~JsonParser() { }
+    /************************** Json Key Pool ********************************/
 
     /**
-     * Get the current char
+     * The table is kept at most half full
      */
-    char Json::JsonParser::current() {
-        if (_position > _text.size())
-            return '\0';
-        return _text[_position];
+    void Json::KeyPool::grow() {
+        vector<Key> keys(_keys.empty() ? 64 : _keys.size() * 2);
+        size_t mask = keys.size() - 1;
+
+        for (auto& key : _keys) {
+            if (!key.size()) continue;
+            size_t slot = key.hash() & mask;
+            while (keys[slot].size())
+                slot = (slot + 1) & mask;
+            keys[slot] = std::move(key);
+        }
+        _keys.swap(keys);
     }
 
     /**
-     * Next position
+     * An inline key is not worth sharing
      */
-    void Json::JsonParser::next() {
-        _position++;
+    Json::Key Json::KeyPool::intern(string_view text) {
+        if (text.size() <= Key::INLINE_KEY)
+            return Key(text);
+
+        if ((_size + 1) * 2 > _keys.size())
+            grow();
+
+        size_t hash = Key::hashOf(text);
+        size_t mask = _keys.size() - 1;
+        size_t slot = hash & mask;
+
+        for (; _keys[slot].size(); slot = (slot + 1) & mask) {
+            if (_keys[slot].matches(text, hash))
+                return _keys[slot];
+        }
+
+        _keys[slot] = Key(text, _resource);
+        _size++;
+        return _keys[slot];
     }
 
+    void Json::KeyPool::internString(string_view text, Json& json) {
+        auto found = _strings.find(text);
+
+        if (found != _strings.end()) {
+            json = found->second;
+            return;
+        }
+
+        json.setString(text, _resource);
+        _strings.emplace(json.stringView(), json);
+    }
+
+
+    /************************** Json Tree Builder **************************/
+
     /**
-     * Ignore whitespace
+     * Adds a value to the innermost container
+     * (the root when there is none)
      */
-    void Json::JsonParser::ignoreWhiteSpace() {
-        while (isWhiteSpace(current())) next();
+    bool Json::TreeBuilder::add(Json&& value) {
+        if (_options.ownership == Ownership::Local)
+            value.makeLocal();
+
+        if (_stack.empty()) {
+            _root = std::move(value);
+            return true;
+        }
+
+        auto& parent = *_stack.back().impl();
+
+        if (parent._type == JsonType::Array)
+            parent._array.emplace_back(std::move(value));
+        else
+            parent._object.try_emplace(std::move(_keys.back()), std::move(value));
+
+        return true;
+    }
+
+    bool Json::TreeBuilder::onNull() { return add(Json(nullptr)); }
+    bool Json::TreeBuilder::onUndefined() { return add(Json()); }
+    bool Json::TreeBuilder::onInt(long long value) { return add(Json(value)); }
+    bool Json::TreeBuilder::onFloat(double value) { return add(Json(value)); }
+    bool Json::TreeBuilder::onBool(bool value) { return add(Json(value)); }
+    bool Json::TreeBuilder::onString(string_view value) {
+        Json json;
+
+        if (_options.internStrings && value.size() > SHORT_STRING && value.size() <= INTERNED_STRING)
+            _pool.internString(value, json);
+        else
+            json.setString(value, _resource);
+
+        return add(std::move(json));
+    }
+
+    bool Json::TreeBuilder::onStartObject() {
+        _stack.push_back(Json(Object(_resource)));
+        _keys.emplace_back();
+        return true;
+    }
+
+    bool Json::TreeBuilder::onKey(string_view key) {
+        _keys.back() = _options.internKeys ? _pool.intern(key) : Key(key, _resource);
+        return true;
+    }
+
+    bool Json::TreeBuilder::onEndObject(size_t) {
+        Json value = std::move(_stack.back());
+        _stack.pop_back();
+        _keys.pop_back();
+        return add(std::move(value));
+    }
+
+    bool Json::TreeBuilder::onStartArray() {
+        _stack.push_back(Json(Array(_resource)));
+        _keys.emplace_back();
+        return true;
+    }
+
+    bool Json::TreeBuilder::onEndArray(size_t count) {
+        return onEndObject(count);
     }
 
     /**
-     * returns true if char is a digit
+     * A container that is parsed when it is accessed
      */
-    bool Json::JsonParser::isDigit(const char& c) {
-        return (c >= 48 && c <= 57);
+    bool Json::TreeBuilder::onSkipped(string_view text) {
+        JsonType type = text[0] == '{' ? JsonType::Object : JsonType::Array;
+        Json value;
+        value.store(Impl::create(_resource, type, Impl::Source{ _input, text }));
+        value._type = type;
+        return add(std::move(value));
     }
+
+    
+    /************************** Json Object ********************************/
+
     /**
-     * returns true if char is whitespace
+     * Position of the member with the <key> or NOT_FOUND
      */
-    bool Json::JsonParser::isWhiteSpace(const char& c) {
-        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    size_t Json::Object::lookup(string_view key, size_t hash) const {
+        if (_index.empty()) {
+            for (size_t i = 0; i < _members.size(); i++) {
+                const Key& member = _members[i].first;
+                if (member.matches(key, hash)) return i;
+            }
+            return NOT_FOUND;
+        }
+
+        size_t mask = _index.size() - 1;
+        for (size_t slot = hash & mask; _index[slot]; slot = (slot + 1) & mask) {
+            size_t position = _index[slot] - 1;
+            const Key& member = _members[position].first;
+            if (member.matches(key, hash)) return position;
+        }
+        return NOT_FOUND;
     }
-    
+
     /**
-     * Parser methods for:
-     * <number>
-     * <bool>
-     * <string>
-     * <object>
-     * <array>
+     * Keeps the index up to date after a member is appended,
+     * the index is kept at most half full
      */
+    void Json::Object::indexLast() {
+        if (_index.empty() ? _members.size() > INDEXED_SIZE : _members.size() * 2 > _index.size())
+            return rebuildIndex();
+
+        if (_index.empty())
+            return;
+
+        size_t mask = _index.size() - 1;
+        size_t slot = _members.back().first.hash() & mask;
+        while (_index[slot])
+            slot = (slot + 1) & mask;
+        _index[slot] = (uint32_t)_members.size();
+    }
 
-    Json Json::JsonParser::parseNumber() {
-        int start = _position;
+    void Json::Object::rebuildIndex() {
+        size_t capacity = 64;
+        while (capacity < _members.size() * 4)
+            capacity *= 2;
 
-        while ( isDigit(current()) )
-            next();
+        _index.assign(capacity, 0);
+        size_t mask = capacity - 1;
+
+        for (size_t i = 0; i < _members.size(); i++) {
+            size_t slot = _members[i].first.hash() & mask;
+            while (_index[slot])
+                slot = (slot + 1) & mask;
+            _index[slot] = (uint32_t)(i + 1);
+        }
+    }
 
-        if( current() == '.' )
-            return parseFloat(start);
-        
-        int length = _position - start;
-        
-        long long value = stoll(_text.substr(start, length));
+    Json::Object::iterator Json::Object::find(string_view key) {
+        size_t position = lookup(key, Key::hashOf(key));
+        return position == NOT_FOUND ? _members.end() : _members.begin() + position;
+    }
 
-        return Json(value);
+    Json::Object::const_iterator Json::Object::find(string_view key) const {
+        size_t position = lookup(key, Key::hashOf(key));
+        return position == NOT_FOUND ? _members.end() : _members.begin() + position;
     }
 
-    Json Json::JsonParser::parseFloat(int& start) {
-        next();
-        while ( isDigit(current()) )
-            next();
-        
-        int length = _position - start;
+    Json::Object::iterator Json::Object::find(string_view key, size_t hash) {
+        size_t position = lookup(key, hash);
+        return position == NOT_FOUND ? _members.end() : _members.begin() + position;
+    }
 
-        auto value = stold(_text.substr(start, length));
+    Json& Json::Object::at(string_view key) {
+        size_t position = lookup(key, Key::hashOf(key));
+        if (position == NOT_FOUND)
+            throw out_of_range("Json::Object::at: missing key '" + string(key) + "'");
+        return _members[position].second;
+    }
 
-        return Json(value);
+    const Json& Json::Object::at(string_view key) const {
+        return const_cast<Object*>(this)->at(key);
     }
 
-    Json Json::JsonParser::parseBool() {
-        bool value = _text.substr(_position, 4) == "true";
+    pair<Json::Object::iterator, bool> Json::Object::insert_or_assign(Key key, Json value) {
+        auto inserted = try_emplace(std::move(key), std::move(value));
+        if (!inserted.second)
+            inserted.first->second = std::move(value);
+        return inserted;
+    }
 
-        if(value) _position += 4;
-        else _position += 5;
 
-        return Json(value);
+    /************************** Json Heap String ********************************/
+
+    Json::HeapString* Json::HeapString::create(pmr::memory_resource* resource, const string_view& value) {
+        void* memory = resource->allocate(sizeof(HeapString) + value.size(), alignof(HeapString));
+        HeapString* string = new (memory) HeapString(resource, value.size());
+        memcpy((char*)(string + 1), value.data(), value.size());
+        return string;
     }
-    
-    Json Json::JsonParser::parseString() {
-        return Json(getParsedString());
+
+    void Json::HeapString::destroy(HeapString* string) {
+        pmr::memory_resource* resource = string->_resource;
+        size_t size = sizeof(HeapString) + string->_length;
+        string->~HeapString();
+        resource->deallocate(string, size, alignof(HeapString));
     }
 
-    string Json::JsonParser::getParsedString() {
-        next();
-        int start = _position;
 
-        while ( current() != '"' )
-            next();
-        
-        int length = _position - start;
-        
-        next();
-        return _text.substr(start, length);
+    /************************** Json Impl ********************************/
+
+    Json::Impl::Impl(pmr::memory_resource* resource, const Object& value)
+        :HeapHeader(resource, JsonType::Object), _object(value, resource) { }
+
+    /**
+     * An object of another resource is copied member by member
+     */
+    Json::Impl::Impl(pmr::memory_resource* resource, Object&& value)
+        :HeapHeader(resource, JsonType::Object), _object(resource)
+    {
+        if (value.resource() == resource)
+            _object = std::move(value);
+        else try {
+            _object = value;
+        }
+        catch (...) {
+            _object.~Object();
+            throw;
+        }
+    }
+
+    Json::Impl::Impl(pmr::memory_resource* resource, const vector<Json>& value)
+        :HeapHeader(resource, JsonType::Array), _array(value.begin(), value.end(), resource) { }
+
+    Json::Impl::Impl(pmr::memory_resource* resource, vector<Json>&& value)
+        :HeapHeader(resource, JsonType::Array), _array(make_move_iterator(value.begin()), make_move_iterator(value.end()), resource) { }
+
+    Json::Impl::Impl(pmr::memory_resource* resource, Array&& value)
+        :HeapHeader(resource, JsonType::Array), _array(std::move(value), resource) { }
+
+    Json::Impl::Impl(pmr::memory_resource* resource, JsonType type, const Source& source)
+        :HeapHeader(resource, type, LAZY), _source(source) { }
+
+    Json::Impl::~Impl() {
+        if (_state.load(memory_order_relaxed) != READY) {
+            _source.~Source();
+            return;
+        }
+
+        if (_type == JsonType::Object)
+            _object.~Object();
+        else
+            _array.~vector();
     }
-    
-    pair<string, Json> Json::JsonParser::getKeyValue() {
-        pair<string, Json> kv;
 
-        if (current() != '"') {
-            _reporter.ReportUnexpectedChar(current(), _position, '"', "[KEY, value] of an object");
-            _position++;
-            return kv;
+    template<class... Args>
+    Json::Impl* Json::Impl::create(pmr::memory_resource* resource, Args&&... args) {
+        void* memory = resource->allocate(sizeof(Impl), alignof(Impl));
+        try {
+            return new (memory) Impl(resource, std::forward<Args>(args)...);
         }
+        catch (...) {
+            resource->deallocate(memory, sizeof(Impl), alignof(Impl));
+            throw;
+        }
+    }
+
+    void Json::Impl::destroy(Impl* impl) {
+        pmr::memory_resource* resource = impl->_resource;
+        impl->~Impl();
+        resource->deallocate(impl, sizeof(Impl), alignof(Impl));
+    }
+
 
-        kv.first = getParsedString();
-        ignoreWhiteSpace();
+    /**
+     * Parses a lazy container, the first thread to get here
+     * parses it while the others wait. When the resource runs out
+     * of memory the container stays lazy and the error is thrown
+     */
+    void Json::Impl::materialize() {
+        uint8_t expected = LAZY;
+
+        if (!_state.compare_exchange_strong(expected, PARSING, memory_order_acquire)) {
+            while ((expected = _state.load(memory_order_acquire)) != READY) {
+                if (expected == LAZY)
+                    return materialize();
+                this_thread::yield();
+            }
+            return;
+        }
 
-        if (current() != ':') {
-            _reporter.ReportUnexpectedChar(current(), _position, ':', "[key, value] of an object");
-            _position++;
-            return kv;
+        Json root;
+        try {
+            ParseOptions options(_ownership);
+            options.resource = _resource;
+            TreeBuilder builder(options, _source.input);
+            JsonReader<TreeBuilder> reader(_source.text, builder, false);
+            reader.parseShallow(1);
+            root = std::move(builder.Root());
+        }
+        catch (...) {
+            _state.store(LAZY, memory_order_release);
+            throw;
         }
 
-        next();
-        kv.second = parse();
-        return kv;
+        _source.~Source();
+        bool parsed = root._type == _type;
+
+        if (_type == JsonType::Object)
+            new (&_object) Object(parsed ? std::move(root.impl()->_object) : Object(_resource));
+        else
+            new (&_array) Array(parsed ? std::move(root.impl()->_array) : Array(_resource));
+
+        _state.store(READY, memory_order_release);
     }
 
-    Json Json::JsonParser::parseObject() {
-        unordered_map<string, Json> value;
-        pair<string, Json> kv;
 
-        next();
-        while ( true ) {
+    /************************** Json ********************************/
 
-            ignoreWhiteSpace();
-            kv = getKeyValue();
-            value.insert(kv);
-            ignoreWhiteSpace();
+    static_assert(sizeof(Json) == 16, "A Json value must fit in 16 bytes");
 
-            char curr = current();
+    /**
+     * Returns true if the value lives in an Impl
+     */
+    bool Json::isHeap() const {
+        return _type == JsonType::Object || _type == JsonType::Array ||
+            (_type == JsonType::String && _length == HEAP_STRING);
+    }
 
-            if ( curr == ',' ) {
-                next();
-                continue;
-            }
-            
-            else if( curr == '}' ) {
-                next();
-                break;
+    /**
+     * Shared ownership of the heap value
+     */
+    void Json::retain() {
+        if (!isHeap())
+            return;
+
+        auto& references = header()->_references;
+
+        if (header()->_ownership == Ownership::Local)
+            references.store(references.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        else
+            references.fetch_add(1, memory_order_relaxed);
+    }
+
+    void Json::release() {
+        if (isHeap()) {
+            auto& references = header()->_references;
+            uint32_t left;
+
+            if (header()->_ownership == Ownership::Local) {
+                left = references.load(memory_order_relaxed) - 1;
+                references.store(left, memory_order_relaxed);
             }
+            else
+                left = references.fetch_sub(1, memory_order_acq_rel) - 1;
 
-            else {
-                _reporter.ReportUnexpectedChar(current(), _position, '}', "End of an object");
-                break;
+            if (left == 0) {
+                if (_type == JsonType::String) HeapString::destroy(heapString());
+                else Impl::destroy(impl());
             }
+        }
+        _type = JsonType::Undefined;
+    }
 
+    /**
+     * The Impl of an object or an array, parsed if it is lazy
+     */
+    Json::Impl* Json::container() const {
+        Impl* value = impl();
+        if (value->_state.load(memory_order_acquire) != Impl::READY)
+            value->materialize();
+        return value;
+    }
+
+    /**
+     * Gives the heap value to the current thread
+     */
+    void Json::makeLocal() {
+        if (isHeap()) {
+            header()->_ownership = Ownership::Local;
+            header()->_owner = this_thread::get_id();
         }
-        return Json(value);
     }
-    
-    Json Json::JsonParser::parseArray()  {
-        vector<Json> value;
 
-        next();
+    /**
+     * Returns false if a local heap value of
+     * the tree belongs to another thread
+     */
+    bool Json::isOwned() const {
+        if (!isHeap())
+            return true;
+
+        if (header()->_ownership == Ownership::Local && header()->_owner != this_thread::get_id())
+            return false;
+
+        if (_type == JsonType::String)
+            return true;
+
+        const Impl& value = *impl();
 
-        while ( true ) {
+        if (value._state.load(memory_order_acquire) != Impl::READY)
+            return true;
 
-            const auto& val = parse();
+        if (value._type == JsonType::Object) {
+            for (const auto& kv : value._object)
+                if (!kv.second.isOwned()) return false;
+        }
+        else {
+            for (const auto& e : value._array)
+                if (!e.isOwned()) return false;
+        }
+        return true;
+    }
 
-            value.emplace_back(val);
+    /**
+     * Converts a local tree so that it can be handed to other threads
+     */
+    bool Json::share() {
+        if (!isOwned())
+            return false;
 
-            ignoreWhiteSpace();
+        vector<const Json*> pending;
+        if (isHeap())
+            pending.push_back(this);
 
-            char curr = current();
+        while (!pending.empty()) {
+            const Json& json = *pending.back();
+            pending.pop_back();
+            json.header()->_ownership = Ownership::Shared;
 
-            if ( curr == ',' ) {
-                next();
+            if (json._type == JsonType::String)
                 continue;
-            }
-            
-            else if( curr == ']' ) {
-                next();
-                break;
-            }
 
+            Impl& value = *json.impl();
+
+            if (value._state.load(memory_order_acquire) != Impl::READY)
+                continue;
+
+            if (value._type == JsonType::Object) {
+                for (auto& kv : value._object)
+                    if (kv.second.isHeap()) pending.push_back(&kv.second);
+            }
             else {
-                _reporter.ReportUnexpectedChar(current(), _position, ']', "End of an array");
-                _position++;
-                break;
+                for (auto& e : value._array)
+                    if (e.isHeap()) pending.push_back(&e);
             }
-
         }
+        return true;
+    }
+
+    bool Json::isShared() const {
+        if (!isHeap())
+            return true;
+
+        if (header()->_ownership == Ownership::Local)
+            return false;
 
-        return Json(value);
+        if (_type == JsonType::String)
+            return true;
+
+        const Impl& value = *impl();
+
+        if (value._state.load(memory_order_acquire) != Impl::READY)
+            return true;
+
+        if (value._type == JsonType::Object) {
+            for (const auto& kv : value._object)
+                if (!kv.second.isShared()) return false;
+        }
+        else {
+            for (const auto& e : value._array)
+                if (!e.isShared()) return false;
+        }
+        return true;
     }
-    
+
     /**
-     * The parse method - the core of all
+     * The string value
      */
-    Json Json::JsonParser::parse() {
-        
-        ignoreWhiteSpace();
+    string_view Json::stringView() const {
+        if (_type != JsonType::String)
+            return string_view();
+        if (_length == HEAP_STRING)
+            return heapString()->view();
+        return string_view(_storage, _length);
+    }
 
-        if ( isDigit(current()) )
-            return parseNumber();
-        
-        switch (current()) {
-            case '"':
-                return parseString();
-            case '{':
-                return parseObject();
-            case '[':
-                return parseArray();
+    void Json::setString(const string_view& value, pmr::memory_resource* resource) {
+        if (value.size() <= SHORT_STRING) {
+            memcpy(_storage, value.data(), value.size());
+            _length = (uint8_t)value.size();
         }
+        else {
+            store(HeapString::create(resource, value));
+            _length = HEAP_STRING;
+        }
+        _type = JsonType::String;
+    }
 
-        if (_text.substr(_position, 4) == "true" || _text.substr(_position, 5) == "false")
-            return parseBool();
+    /**
+     * The memory of the values, operator new is called for every
+     * allocation, so a replaced operator new sees them too
+     * (pmr::new_delete_resource only calls the aligned one)
+     */
+    class HeapResource : public pmr::memory_resource {
 
-        else if (_text.substr(_position, 4) == "null")
-            return _position += 4, Json(nullptr);
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                return ::operator new(bytes, align_val_t(alignment));
+            return ::operator new(bytes);
+        }
 
-        else if( _text.substr(_position, 9) == "undefined" )
-            return _position += 9, Json();
+        void do_deallocate(void* memory, size_t, size_t alignment) override {
+            if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                ::operator delete(memory, align_val_t(alignment));
+            else
+                ::operator delete(memory);
+        }
 
-        _reporter.ReportUnexpectedChar(current(), _position, '@', "Any valid json value");
-        return Json();
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
 
+    /**
+     * Never destroyed, the values in static storage may outlive it
+     */
+    pmr::memory_resource* Json::heap() {
+        alignas(HeapResource) static char storage[sizeof(HeapResource)];
+        static pmr::memory_resource* resource = new (storage) HeapResource();
+        return resource;
     }
 
-    /************************** Json ********************************/
+    pmr::memory_resource* Json::resource() const {
+        return isHeap() ? header()->_resource : heap();
+    }
 
     /**
      * Default constructor - undefindes
      */
     Json::Json() 
-        :_impl(new Impl)
-    { 
-        _impl->_type = Json::JsonType::Undefined;
-    }
+        :_length(0), _type(JsonType::Undefined) { }
     /**
      *  Constructor - null value initialized
      */
     Json::Json(const nullptr_t& nptr)
-        :_impl(new Impl)
-    {
-        _impl->_type = Json::JsonType::Null;
-    }
+        :_length(0), _type(JsonType::Null) { }
     /**
      *  Constructor - _int value initialized
      */
     Json::Json(const int& value) 
-        :_impl(new Impl)
+        :_length(0), _type(JsonType::Int)
     {
-        _impl->_type = Json::JsonType::Int;
-        _impl->_int = value;
+        store((long long)value);
     }
     /**
      *  Constructor - _int value initialized
      */
     Json::Json(const long long& value) 
-        :_impl(new Impl)
+        :_length(0), _type(JsonType::Int)
     {
-        _impl->_type = Json::JsonType::Int;
-        _impl->_int = value;
+        store(value);
     }
     /**
      *  Constructor - _float value initialized
      */
     Json::Json(const double& value)
-        :_impl(new Impl)
+        :_length(0), _type(JsonType::Float)
     {
-        _impl->_type = Json::JsonType::Float;
-        _impl->_float = value;
+        store(value);
     }
     /**
      *  Constructor - _float value initialized
      */
     Json::Json(const long double& value)
-        :_impl(new Impl)
+        :_length(0), _type(JsonType::Float)
     {
-        _impl->_type = Json::JsonType::Float;
-        _impl->_float = value;
+        store((double)value);
     }
     /**
      *  Constructor - _bool value initialized
      */
     Json::Json(const bool& value)
-        :_impl(new Impl)
+        :_length(0), _type(JsonType::Bool)
     {
-        _impl->_type = Json::JsonType::Bool;
-        _impl->_bool = value;
+        store(value);
     }
     /**
      *  Constructor - _string value initialized
      */
     Json::Json(const char* value)
-        :_impl(new Impl)
+        :_length(0)
     {
-        _impl->_type = Json::JsonType::String;
-        _impl->_string = new string(value);
+        setString(value);
     }
     /**
      *  Constructor - _string value initialized
      */
     Json::Json(const string& value)
-        :_impl(new Impl)
+        :_length(0)
+    {
+        setString(value);
+    }
+    Json::Json(string&& value)
+        :_length(0)
     {
-        _impl->_type = Json::JsonType::String;
-        _impl->_string = new string(value);
+        setString(value);
+    }
+    Json::Json(pmr::string&& value)
+        :_length(0)
+    {
+        setString(value, value.get_allocator().resource());
     }
     /**
      *  Constructor - _object value initialized
      */
+    Json::Json(const Object& value)
+        :_length(0), _type(JsonType::Object)
+    {
+        store(Impl::create(heap(), value));
+    }
+    Json::Json(Object&& value)
+        :_length(0), _type(JsonType::Object)
+    {
+        store(Impl::create(value.resource(), std::move(value)));
+    }
     Json::Json(const unordered_map<string, Json>& value)
-        :_impl(new Impl)
+        :_length(0), _type(JsonType::Object)
+    {
+        Object object;
+        object.reserve(value.size());
+        for (const auto& kv : value)
+            object.try_emplace(kv.first, kv.second);
+        store(Impl::create(heap(), std::move(object)));
+    }
+    Json::Json(unordered_map<string, Json>&& value)
+        :_length(0), _type(JsonType::Object)
     {
-        _impl->_type = Json::JsonType::Object;
-        _impl->_object = new unordered_map<string, Json>(value);
+        Object object;
+        object.reserve(value.size());
+        for (auto& kv : value)
+            object.try_emplace(kv.first, std::move(kv.second));
+        store(Impl::create(heap(), std::move(object)));
     }
     /**
      *  Constructor - _array value initialized
      */
     Json::Json(const vector<Json>& value)
-        :_impl(new Impl)
+        :_length(0), _type(JsonType::Array)
+    {
+        store(Impl::create(heap(), value));
+    }
+    Json::Json(vector<Json>&& value)
+        :_length(0), _type(JsonType::Array)
     {
-        _impl->_type = Json::JsonType::Array;
-        _impl->_array = new vector<Json>(value);
+        store(Impl::create(heap(), std::move(value)));
+    }
+    Json::Json(Array&& value)
+        :_length(0), _type(JsonType::Array)
+    {
+        store(Impl::create(value.get_allocator().resource(), std::move(value)));
     }
     
-    Json::Json::~Json() { }
+    Json::~Json() {
+        release();
+    }
 
     Json::Json(const Json& other) { 
-        _impl = other._impl;
+        memcpy((void*)this, (const void*)&other, sizeof(Json));
+        retain();
     }
 
+    /**
+     * The <other> json can live inside this one (a child assigned
+     * to its parent), it is copied before this one is released
+     */
     Json& Json::operator=(const Json& other) {
-        _impl = other._impl;
+        if (this == &other)
+            return *this;
+
+        Json copy(other);
+        release();
+        memcpy((void*)this, (const void*)&copy, sizeof(Json));
+        copy._type = JsonType::Undefined;
+        return *this;
+    }
+
+    /**
+     * Moving takes the payload as it is,
+     * the other json is left undefined
+     */
+    Json::Json(Json&& other) noexcept {
+        memcpy((void*)this, (const void*)&other, sizeof(Json));
+        other._type = JsonType::Undefined;
+    }
+
+    Json& Json::operator=(Json&& other) noexcept {
+        if (this == &other)
+            return *this;
+
+        Json taken(std::move(other));
+        release();
+        memcpy((void*)this, (const void*)&taken, sizeof(Json));
+        taken._type = JsonType::Undefined;
+        return *this;
+    }
+
+    /**
+     * Array mutators
+     */
+    Json& Json::push_back(const Json& value) {
+        return emplace_back(value);
+    }
+
+    Json& Json::push_back(Json&& value) {
+        return emplace_back(std::move(value));
+    }
+
+    /**
+     * Object mutators
+     */
+    Json& Json::set(Key key, Json value) {
+        if (_type != JsonType::Object)
+            return *this;
+        return container()->_object.insert_or_assign(std::move(key), std::move(value)).first->second;
     }
 
 
@@ -371,76 +909,428 @@ namespace JsonSer
      * <object key>
      */
     Json& Json::operator[](int i) {
-        if(_impl->_type == JsonType::Array && i >= 0)
-            return _impl->_array->at(i);
+        if(_type == JsonType::Array && i >= 0)
+            return container()->_array.at(i);
         return *this;
     }
 
     Json& Json::operator[](const char* key) {
-        if(_impl->_type == JsonType::Object) 
-            return _impl->_object->at(key);
+        if(_type == JsonType::Object) 
+            return container()->_object.at(key);
         return *this;
     }
 
-    Json& Json::operator[](string key) {
-        if(_impl->_type == JsonType::Object) 
-            return _impl->_object->at(key);
+    Json& Json::operator[](const string& key) {
+        if(_type == JsonType::Object) 
+            return container()->_object.at(key);
         return *this;
     }
 
     /**
-     * To string
+     * Getting a json from string
      */
-    string Json::stringifyObject() const {
-        string element = "";
-        element += "{";
+    Json Json::fromString(string_view text) {
+        vector<string> diagnostics;
+        return fromString(text, diagnostics);
+    }
+    Json Json::fromString(string_view text, const ParseOptions& options) {
+        vector<string> diagnostics;
+        return fromString(text, diagnostics, options);
+    }
+    Json Json::fromString(string_view text, vector<string>& diagnostics, const ParseOptions& options) {
+        if (!options.lazy)
+            return parse(text, nullptr, diagnostics, options);
 
-        for(const auto& kv : *_impl->_object) 
-            element += "\"" + kv.first + "\":" + kv.second.toString() + ",";
-        
-        if(_impl->_object->begin() != _impl->_object->end())
-            element.pop_back();
+        auto input = make_shared<const string>(text);
+        return parse(*input, input, diagnostics, options);
+    }
+    /**
+     * Parses the <text>, the <input> owns it in lazy parsing
+     */
+    Json Json::parse(string_view text, const shared_ptr<const void>& input,
+        vector<string>& diagnostics, const ParseOptions& options)
+    {
+        Json result;
+        if (parseArrayParallel(text, options, diagnostics, result))
+            return result;
+
+        /**
+         * The reader without statistics unless they are asked for
+         */
+        auto read = [&](auto& stats) {
+            TreeBuilder builder(options, input);
+            JsonReader<TreeBuilder, decay_t<decltype(stats)>> reader(text, builder, !options.lazy);
+
+            if (options.lazy ? reader.parseShallow(0) : reader.parse())
+                reader.expectEnd();
+
+            stats += reader.Statistics();
+            auto& reported = reader.Diagnostics();
+            diagnostics.insert(diagnostics.end(), reported.begin(), reported.end());
+            return builder.Root();
+        };
+
+        if (options.stats)
+            return read(*options.stats);
+
+        NoParseStats none;
+        return read(none);
+    }
+    Json Json::fromString(const char* text, size_t length) {
+        return fromString(string_view(text, length));
+    }
+    /**
+     * Getting a json from a file
+     */
+    Json Json::fromFile(const string& path) {
+        vector<string> diagnostics;
+        return fromFile(path, diagnostics);
+    }
+    Json Json::fromFile(const string& path, vector<string>& diagnostics, const ParseOptions& options) {
+        auto file = make_shared<const MappedFile>(path);
+
+        if (!file->isOpen()) {
+            Reporter reporter;
+            reporter.ReportUnreadableFile(path);
+            diagnostics.push_back(reporter.Diagnostics().back());
+            return Json();
+        }
 
-        element += "}";
-        return element;
+        return parse(file->view(), options.lazy ? file : nullptr, diagnostics, options);
     }
-    string Json::stringifyArray() const {
-        string element = "";
-        element += "[";
+    /**
+     * Splits a sequence of values, only brackets, quotes and
+     * whitespace are looked at: containers and strings end when
+     * they are balanced, other values at the next whitespace or
+     * structural char
+     */
+    vector<string_view> Json::splitRecords(string_view text) {
+        vector<string_view> records;
+        const char* data = text.data();
+        const size_t size = text.size();
+        size_t position = 0;
+
+        /**
+         * Position after the string that starts at <position>
+         */
+        auto skipString = [&](size_t position) {
+            size_t end = JsonScanner::endOfString(text, position);
+            return end == string_view::npos ? size : end;
+        };
+
+        while (true) {
+            while (position < size && JsonScanner::isWhiteSpace(data[position]))
+                position++;
+            if (position >= size)
+                break;
 
-        for(const auto& e : *_impl->_array)
-            element += e.toString() + ",";
-        
-        if(_impl->_array->size())
-            element.pop_back();
+            size_t start = position;
+            const char first = data[position++];
+
+            if (first == '"')
+                position = skipString(position);
+            else if (first == '{' || first == '[') {
+                size_t depth = 1;
+                while (position < size && depth > 0) {
+                    const char c = data[position++];
+                    if (c == '"') position = skipString(position);
+                    else if (c == '{' || c == '[') depth++;
+                    else if (c == '}' || c == ']') depth--;
+                }
+            }
+            else if (first != '}' && first != ']') {
+                while (position < size && !JsonScanner::isWhiteSpace(data[position]) &&
+                    data[position] != '{' && data[position] != '[' && data[position] != '"' &&
+                    data[position] != '}' && data[position] != ']')
+                    position++;
+            }
 
-        element += "]";
-        return element;
+            records.push_back(text.substr(start, position - start));
+        }
+        return records;
     }
+
     /**
-     * Getting a json from string
+     * The elements are found with the structural index (quotes and
+     * escapes are already resolved by it): commas at depth 1. They are
+     * parsed in batches of about BATCH bytes straight into their place
+     * in the array
+     *
+     * Each batch has its own TreeBuilder, a key is shared by the
+     * elements of a batch (one copy of each key per batch)
+     */
+    bool Json::parseArrayParallel(string_view text, const ParseOptions& options, vector<string>& diagnostics, Json& result) {
+        static const size_t BATCH = 1 << 16;
+
+        if (text.size() < PARALLEL_ARRAY || options.lazy || options.threads <= 1 ||
+            options.ownership == Ownership::Local)
+            return false;
+
+        if (ThreadPool::workers(options.threads) == 1)
+            return false;
+
+        size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == string_view::npos || text[first] != '[')
+            return false;
+
+        ParseStats total;
+        auto stamp = total.start();
+
+        StructuralIndex index;
+        index.build(text);
+        if (!index.isBuilt())
+            return false;
+
+        total.scanned(stamp);
+
+        /**
+         * Start of every element and the position of the closing bracket
+         */
+        vector<size_t> starts;
+        size_t end = string_view::npos;
+        size_t depth = 0;
+
+        for (const uint32_t& position : index.Positions()) {
+            const char c = text[position];
+
+            if (c == '[' || c == '{') {
+                if (depth++ == 0)
+                    starts.push_back(position + 1);
+            }
+            else if (c == ']' || c == '}') {
+                if (depth == 0)
+                    return false;
+                if (--depth == 0) {
+                    end = position;
+                    break;
+                }
+            }
+            else if (c == ',' && depth == 1)
+                starts.push_back(position + 1);
+        }
+
+        if (end == string_view::npos || text.find_first_not_of(" \t\r\n", end + 1) != string_view::npos)
+            return false;
+
+        /**
+         * "[]" or "[ ]" has no element
+         */
+        if (starts.size() == 1 && text.find_first_not_of(" \t\r\n", starts[0]) == end)
+            return false;
+
+        starts.push_back(end + 1);
+        size_t count = starts.size() - 1;
+
+        vector<size_t> batches;
+        for (size_t i = 0; i < count; i++)
+            if (batches.empty() || starts[i] - starts[batches.back()] >= BATCH)
+                batches.push_back(i);
+        batches.push_back(count);
+
+        Array array(options.resource ? options.resource : heap());
+        array.resize(count);
+
+        /**
+         * First batch with a malformed element (none when it is the
+         * number of batches), the batches after it stop
+         */
+        atomic<size_t> failed(batches.size() - 1);
+
+        vector<ParseStats> batchStats(options.stats ? batches.size() - 1 : 0);
+
+        auto parseBatch = [&](size_t batch, auto& stats) {
+            TreeBuilder builder(options);
+
+            for (size_t i = batches[batch]; i < batches[batch + 1] && batch < failed.load(memory_order_relaxed); i++) {
+                string_view element = text.substr(starts[i], starts[i + 1] - 1 - starts[i]);
+                JsonReader<TreeBuilder, decay_t<decltype(stats)>> reader(element, builder);
+                reader.parse();
+
+                if (!reader.Diagnostics().empty() || !reader.isAtEnd()) {
+                    size_t first = failed.load(memory_order_relaxed);
+                    while (batch < first && !failed.compare_exchange_weak(first, batch, memory_order_relaxed)) { }
+                }
+
+                stats += reader.Statistics();
+                array[i] = builder.Take();
+            }
+        };
+        auto task = [&](size_t batch) {
+            if (options.stats)
+                return parseBatch(batch, batchStats[batch]);
+
+            NoParseStats none;
+            parseBatch(batch, none);
+        };
+        ThreadPool::run(options.threads, batches.size() - 1, task);
+
+        /**
+         * The elements are one level below the array
+         */
+        size_t broken = failed.load();
+        if (options.stats) {
+            for (size_t batch = 0; batch < broken; batch++)
+                total += batchStats[batch];
+            total.maxDepth++;
+        }
+
+        /**
+         * The positions of the diagnostics would be relative to the
+         * elements: the batches before the malformed element are kept
+         * and the array is parsed serially from the start of its batch
+         */
+        if (broken < batches.size() - 1) {
+            size_t kept = batches[broken];
+            array.resize(kept);
+
+            TreeBuilder builder(options);
+            builder.onStartArray();
+
+            auto resume = [&](auto& stats) {
+                JsonReader<TreeBuilder, decay_t<decltype(stats)>> reader(text, builder);
+                if (reader.resumeArray(starts[kept], kept))
+                    reader.expectEnd();
+
+                stats += reader.Statistics();
+                auto& reported = reader.Diagnostics();
+                diagnostics.insert(diagnostics.end(), reported.begin(), reported.end());
+            };
+            if (options.stats)
+                resume(total);
+            else {
+                NoParseStats none;
+                resume(none);
+            }
+
+            for (Json& element : builder.Root().impl()->_array)
+                array.push_back(std::move(element));
+        }
+
+        if (options.stats) {
+            total.bytes = text.size();
+            total.arrays++;
+            *options.stats += total;
+        }
+
+        result = Json(std::move(array));
+        return true;
+    }
+
+    /**
+     * The records are parsed in batches of about BATCH bytes
      */
-    Json Json::fromString(const string& text) {
-        auto parser = JsonParser(text);
-        auto json = parser.parse();
-        json._diagnostics = parser.Diagnostics();
-        return json;
+    vector<Json::Record> Json::parseMany(string_view text, const ParseOptions& options) {
+        static const size_t BATCH = 1 << 16;
+
+        vector<string_view> records = splitRecords(text);
+        vector<Record> results(records.size());
+
+        vector<size_t> batches;
+        size_t bytes = BATCH;
+        for (size_t i = 0; i < records.size(); i++) {
+            if (bytes >= BATCH) {
+                batches.push_back(i);
+                bytes = 0;
+            }
+            bytes += records[i].size();
+        }
+        batches.push_back(records.size());
+
+        /**
+         * The values are handed from the workers to the
+         * calling thread, they can't be local to a worker
+         */
+        ParseOptions shared = options;
+        shared.ownership = Ownership::Shared;
+
+        /**
+         * Every batch has its own statistics, they are added up at the end
+         */
+        shared.stats = nullptr;
+        vector<ParseStats> batchStats(options.stats ? batches.size() - 1 : 0);
+
+        auto parseBatch = [&](size_t batch, auto& stats) {
+            TreeBuilder builder(shared);
+            ParseOptions lazy = shared;
+            lazy.stats = options.stats ? &batchStats[batch] : nullptr;
+
+            for (size_t i = batches[batch]; i < batches[batch + 1]; i++) {
+                if (shared.lazy) {
+                    results[i].value = fromString(records[i], results[i].diagnostics, lazy);
+                    continue;
+                }
+
+                JsonReader<TreeBuilder, decay_t<decltype(stats)>> reader(records[i], builder);
+                if (reader.parse())
+                    reader.expectEnd();
+
+                stats += reader.Statistics();
+                results[i].value = builder.Take();
+                results[i].diagnostics = std::move(reader.Diagnostics());
+            }
+        };
+        auto task = [&](size_t batch) {
+            if (options.stats)
+                return parseBatch(batch, batchStats[batch]);
+
+            NoParseStats none;
+            parseBatch(batch, none);
+        };
+
+        ThreadPool::run(options.threads, batches.size() - 1, task);
+
+        for (const ParseStats& stats : batchStats)
+            *options.stats += stats;
+
+        return results;
     }
+
     /**
      * Getting a string from json
      */
     string Json::toString() const {
-        switch (_impl->_type) {
-            case JsonType::Undefined: return "undefined";
-            case JsonType::Null: return "null";
-            case JsonType::Int: return to_string(_impl->_int);
-            case JsonType::Float: return to_string(_impl->_float);
-            case JsonType::String: return "\"" + *(_impl->_string) + "\"";
-            case JsonType::Bool: return _impl->_bool == true ? "true":"false";
-            case JsonType::Object: return stringifyObject();
-            case JsonType::Array: return stringifyArray();
-            default: return "";
-        }
+        string text;
+        JsonWriter(text).write(*this);
+        return text;
+    }
+    /**
+     * Binary encodings
+     */
+    string Json::toCBOR() const {
+        string data;
+        CborWriter(data).write(*this);
+        return data;
+    }
+    string Json::toMessagePack() const {
+        string data;
+        MessagePackWriter(data).write(*this);
+        return data;
+    }
+    Json Json::fromCBOR(string_view data) {
+        vector<string> diagnostics;
+        return fromCBOR(data, diagnostics);
+    }
+    Json Json::fromCBOR(string_view data, vector<string>& diagnostics, const ParseOptions& options) {
+        TreeBuilder builder(options);
+        CborReader<TreeBuilder> reader(data, builder);
+        reader.parse();
+
+        auto& reported = reader.Diagnostics();
+        diagnostics.insert(diagnostics.end(), reported.begin(), reported.end());
+        return builder.Root();
+    }
+    Json Json::fromMessagePack(string_view data) {
+        vector<string> diagnostics;
+        return fromMessagePack(data, diagnostics);
+    }
+    Json Json::fromMessagePack(string_view data, vector<string>& diagnostics, const ParseOptions& options) {
+        TreeBuilder builder(options);
+        MessagePackReader<TreeBuilder> reader(data, builder);
+        reader.parse();
+
+        auto& reported = reader.Diagnostics();
+        diagnostics.insert(diagnostics.end(), reported.begin(), reported.end());
+        return builder.Root();
     }
 
     /**
@@ -448,103 +1338,109 @@ namespace JsonSer
      */
     Json JsonArray()
     {
-        return Json(vector<Json>());
+        return Json(Json::Array(Json::heap()));
     }
 
     Json JsonArray(initializer_list<Json> arr)
     {
-        return Json(vector<Json>(arr));
+        return Json(Json::Array(arr, Json::heap()));
     }
 
     Json JsonObject()
     {
-        return Json(unordered_map<string, Json>());
+        return Json(Json::Object());
     }
 
     Json JsonObject(initializer_list<pair<string, Json>> obj)
     {
-        unordered_map<string, Json> ret;
+        Json::Object ret;
+        ret.reserve(obj.size());
 
         for(auto& e : obj) 
-            ret.insert(e); 
+            ret.try_emplace(e.first, e.second); 
 
-        return Json(ret);
+        return Json(std::move(ret));
     }
 
     /**
      * Operators overloading
      */
     bool operator==(const Json& instance, const nullptr_t& value) {
-        return instance._impl->_type == Json::JsonType::Null;
+        return instance._type == Json::JsonType::Null;
     }
     bool operator==(const nullptr_t& value, const Json& instance) {
-        return instance._impl->_type == Json::JsonType::Null;
+        return instance._type == Json::JsonType::Null;
     }
 
     bool operator==(const Json& instance, const int& value) {
-        return instance._impl->_type == Json::JsonType::Int ?
-            ((int)instance._impl->_int == value) : false;
+        return instance._type == Json::JsonType::Int ?
+            ((int)instance.load<long long>() == value) : false;
     }
     bool operator==(const int& value, const Json& instance) {
-        return instance._impl->_type == Json::JsonType::Int ?
-            (instance._impl->_int == (long long)value) : false;
+        return instance._type == Json::JsonType::Int ?
+            (instance.load<long long>() == (long long)value) : false;
     }
 
     bool operator==(const Json& instance, const long long& value) {
-        return instance._impl->_type == Json::JsonType::Int ?
-            (instance._impl->_int == value) : false;
+        return instance._type == Json::JsonType::Int ?
+            (instance.load<long long>() == value) : false;
     }
     bool operator==(const long long& value, const Json& instance) {
-        return instance._impl->_type == Json::JsonType::Int ?
-            (instance._impl->_int == value) : false;
+        return instance._type == Json::JsonType::Int ?
+            (instance.load<long long>() == value) : false;
     }
 
     bool operator==(const Json& instance, const double& value) {
-        return instance._impl->_type == Json::JsonType::Float ?
-            ((double)instance._impl->_float == value) : false;
+        return instance._type == Json::JsonType::Float ?
+            (instance.load<double>() == value) : false;
     }
     bool operator==(const double& value, const Json& instance) {
-        return instance._impl->_type == Json::JsonType::Float ?
-            ((double)instance._impl->_float == value) : false;
+        return instance._type == Json::JsonType::Float ?
+            (instance.load<double>() == value) : false;
     }
 
+    /**
+     * Floats are stored as doubles, long doubles
+     * are compared with the same precision
+     */
     bool operator==(const Json& instance, const long double& value) {
-        return instance._impl->_type == Json::JsonType::Float?
-            (instance._impl->_float == value) : false;
+        return instance._type == Json::JsonType::Float?
+            (instance.load<double>() == (double)value) : false;
     }
     bool operator==(const long double& value, const Json& instance) {
-        return instance._impl->_type == Json::JsonType::Float ?
-            (instance._impl->_float == value) : false;
+        return instance._type == Json::JsonType::Float ?
+            (instance.load<double>() == (double)value) : false;
     }
 
     bool operator==(const Json& instance, const bool& value) {
-        return instance._impl->_type == Json::JsonType::Bool ?
-            (instance._impl->_bool == value) : false;
+        return instance._type == Json::JsonType::Bool ?
+            (instance.load<bool>() == value) : false;
     }
     bool operator==(const bool& value, const Json& instance) {
-        return instance._impl->_type == Json::JsonType::Bool ?
-            (instance._impl->_bool == value) : false;
+        return instance._type == Json::JsonType::Bool ?
+            (instance.load<bool>() == value) : false;
     }
 
     bool operator==(const Json& instance, const char* value) {
-        return instance._impl->_type == Json::JsonType::String ?
-            ((*instance._impl->_string) == value) : false;
+        return instance._type == Json::JsonType::String ?
+            (instance.stringView() == value) : false;
     }
     bool operator==(const char* value, const Json& instance) {
-        return instance._impl->_type == Json::JsonType::String ?
-            ((*instance._impl->_string) == value) : false;
+        return instance._type == Json::JsonType::String ?
+            (instance.stringView() == value) : false;
     }
     bool operator==(const Json& instance, const string& value) {
-        return instance._impl->_type == Json::JsonType::String ?
-            ((*instance._impl->_string) == value) : false;
+        return instance._type == Json::JsonType::String ?
+            (instance.stringView() == value) : false;
     }
     bool operator==(const string& value, const Json& instance) {
-        return instance._impl->_type == Json::JsonType::String ?
-            ((*instance._impl->_string) == value) : false;
+        return instance._type == Json::JsonType::String ?
+            (instance.stringView() == value) : false;
     }
 
     ostream& operator<<(std::ostream& os, const Json& json) {
-        return os << json.toString();
+        JsonWriter(os).write(json);
+        return os;
     }
 
-} // namespace Json
+} // namespace Json
\ No newline at end of file
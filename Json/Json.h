@@ -5,20 +5,86 @@
  * Libraries
  */
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
+#include <utility>
+#include <tuple>
 #include <memory>
+#include <memory_resource>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <thread>
 
 namespace JsonSer
 {
     using namespace std;
 
+    struct NoParseStats;
+
+    struct ParseStats;
+
+    template<class Handler, class Stats = NoParseStats>
+    class JsonReader;
+
+    class JsonWriter;
+
+    class CborWriter;
+
+    class MessagePackWriter;
+
+    class BinaryReader;
+
+    class JsonSnapshot;
+
+    class JsonPath;
+
+    class JsonCursor;
+
+    template<size_t N>
+    class JsonSlots;
+
+    class JsonSchema;
+
+    class JsonPushParser;
+
     class Json {
 
+        template<class Handler, class Stats>
+        friend class JsonReader;
+
+        friend struct NoParseStats;
+
+        friend struct ParseStats;
+
+        friend class JsonWriter;
+
+        friend class CborWriter;
+
+        friend class MessagePackWriter;
+
+        friend class BinaryReader;
+
+        friend class JsonSnapshot;
+
+        friend class JsonPath;
+
+        friend class JsonCursor;
+
+        template<size_t N>
+        friend class JsonSlots;
+
+        friend class JsonSchema;
+
+        friend class JsonPushParser;
+
         /**
          * An enum that give a type to a JSON Json
          */
-        enum class JsonType
+        enum class JsonType : uint8_t
         {
             Null,
             Undefined,
@@ -42,7 +108,25 @@ namespace JsonSer
             /**
              * A method for reporting any error
              */
-            void ReportUnexpectedChar(const char&, const int&, const char&, const string& additional = "");
+            void ReportUnexpectedChar(const char&, const size_t&, const char&, const string& additional = "");
+
+            /**
+             * A method for reporting a file that can't be read
+             */
+            void ReportUnreadableFile(const string&);
+
+            /**
+             * Methods for reporting errors of binary inputs
+             */
+            void ReportUnexpectedByte(const uint8_t&, const size_t&, const string& additional = "");
+            void ReportUnexpectedEnd(const size_t&, const string& additional = "");
+
+            /**
+             * Methods for reporting a value (at a position and a path
+             * of the document) that breaks a schema and an invalid schema
+             */
+            void ReportInvalidValue(const size_t&, const string& path, const string& additional = "");
+            void ReportInvalidSchema(const string& path, const string& additional = "");
 
             /**
              * Diagnostic property 
@@ -51,121 +135,217 @@ namespace JsonSer
         };
 
         /**
-         * A parser for the json format
+         * Builds a Json tree from the events of a JsonReader
          */
-        class JsonParser {
+        class TreeBuilder;
 
-            int _position = 0;
-            string _text;
+        /**
+         * The keys and strings of a document being parsed
+         */
+        class KeyPool;
 
-            Reporter _reporter;
+        public: /**************** public members ****************/
 
-            /**
-             * Returns the char of the <_text>
-             * at position <_position>
-             */
-            char current();
+        /**
+         * Who may hold copies of a value:
+         * - Shared: any thread, reference counts are atomic
+         * - Local: the thread that created it, reference counts
+         *   are plain increments until the value is shared
+         */
+        enum class Ownership : uint8_t
+        {
+            Shared,
+            Local
+        };
+
+        /**
+         * An immutable object key, short keys are inline and
+         * the others are shared with a cached hash
+         */
+        class Key;
+
+        /**
+         * Members of an object, in insertion order
+         */
+        class Object;
+
+        /**
+         * Elements of an array (an rvalue Array is taken without copying)
+         */
+        using Array = pmr::vector<Json>;
+
+        /**
+         * Options of fromString and fromFile
+         */
+        struct ParseOptions
+        {
+            Ownership ownership;
 
             /**
-             * Increments position by 1
+             * Keys (and strings values up to INTERNED_STRING chars) that
+             * repeat in the input share one copy for the whole document.
+             * Every parser that builds a Json interns the keys by default,
+             * a lazy container interns the keys of its own level. Keys of
+             * up to Key::INLINE_KEY chars are never allocated
              */
-            void next();
+            bool internKeys;
+            bool internStrings;
 
             /**
-             * Ignore whitespace
+             * Objects and arrays are only parsed when they are first
+             * accessed, until then they keep their range of the input
+             * (the input is kept alive: a copy of the string or the
+             * mapping of the file). The errors of a container are
+             * found when it is parsed and then they are dropped
              */
-            void ignoreWhiteSpace();
+            bool lazy;
 
             /**
-             * Helper functions
+             * Workers of the parallel parsers counting the calling
+             * thread, 0 uses the shared pool (a worker per core).
+             * A big top-level array is only parsed in parallel when
+             * more than 1 thread is asked for, its keys are then
+             * shared by batches of elements instead of the document
              */
-            bool isDigit(const char&);
-            bool isWhiteSpace(const char&);
+            size_t threads;
 
             /**
-             * Parsers
+             * Memory of the strings, keys and containers of the document,
+             * it must outlive them and be thread safe unless threads is 1
+             * (the copy of the input of a lazy document is not in it)
              */
-            Json parseNumber();
-            Json parseFloat(int&);
-            Json parseBool();
-            Json parseString();
-            Json parseObject();
-            Json parseArray();
-            string getParsedString();
-            pair<string, Json> getKeyValue();
-            
-            public: 
+            pmr::memory_resource* resource;
+
             /**
-             *  Default constructor 
+             * The statistics of the parsing (see ParseStats.h) are added
+             * to <stats>, none are collected when it is null. The lazy
+             * containers parsed later and the binary inputs are not counted
              */
-            JsonParser(const string&);
+            ParseStats* stats;
+
+            ParseOptions(Ownership ownership = Ownership::Shared)
+                :ownership(ownership), internKeys(true), internStrings(false), lazy(false), threads(0),
+                resource(heap()), stats(nullptr) { }
+        };
 
-            ~JsonParser();
+        /**
+         * A value of a sequence and the diagnostics of its parsing
+         */
+        struct Record;
 
-            Json parse();
+        /**
+         * Longest string value interned by <internStrings>
+         */
+        static const size_t INTERNED_STRING = 64;
 
-            vector<string>& Diagnostics() { return _reporter.Diagnostics(); }
+        /**
+         * Smallest top-level array parsed in parallel (in bytes)
+         */
+        static const size_t PARALLEL_ARRAY = 1 << 20;
 
-        };
+        private: /**************** private members ****************/
 
         /**
-         * Contains the private members of Json class
+         * Heap storage of long strings and containers,
+         * shared by the copies of a Json
          */
-        struct Impl
-        {
-            /**
-             * Type of the Json
-             */
-            JsonType _type;
+        struct HeapHeader;
+        struct HeapString;
+        struct Impl;
 
-            /**
-             * The value of the json 
-             */
-            union 
-            {
-                long long _int;
-                long double _float;
-                bool _bool;
-                string* _string;
-                unordered_map<string, Json>* _object;
-                vector<Json>* _array;
-            };
-
-            Impl() {};
-
-            ~Impl() {
-                switch (_type) {
-                case JsonType::String:
-                    delete _string;
-                    break;
-                case JsonType::Object:
-                    delete _object;
-                    break;
-                case JsonType::Array:
-                    delete _array;
-                    break;
-                }
-            }
+        /**
+         * The value is stored in 16 bytes:
+         * - ints, floats, bools and strings up to 14 chars in <_storage>
+         * - a pointer to a HeapString for longer strings
+         * - a pointer to an Impl for containers
+         */
+        alignas(8) char _storage[14];
+        uint8_t _length;
+        JsonType _type;
 
-        };
+        /**
+         * <_length> of a string stored in a HeapString
+         */
+        static const uint8_t HEAP_STRING = 0xFF;
+        static const size_t SHORT_STRING = sizeof(_storage);
+
+        /**
+         * Reads and writes the payload of <_storage>
+         */
+        template<class T>
+        T load() const { T value; memcpy(&value, _storage, sizeof(T)); return value; }
+        template<class T>
+        void store(const T& value) { memcpy(_storage, &value, sizeof(T)); }
+
+        /**
+         * Returns true if the value lives on the heap
+         */
+        bool isHeap() const;
+        HeapHeader* header() const { return load<HeapHeader*>(); }
+        HeapString* heapString() const { return load<HeapString*>(); }
+        Impl* impl() const { return load<Impl*>(); }
+        /**
+         * The Impl of an object or an array, parsed if it is lazy
+         */
+        Impl* container() const;
 
+        /**
+         * Shared ownership of the heap value
+         */
+        void retain();
+        void release();
 
         /**
-         * Actually the implemented
+         * Gives the heap value to the current thread
          */
-        shared_ptr<struct Impl> _impl;
+        void makeLocal();
 
-        vector<string> _diagnostics;
+        /**
+         * Returns false if a local heap value of
+         * the tree belongs to another thread
+         */
+        bool isOwned() const;
 
         /**
-         * To string 
+         * Parses the <text>, the <input> owns it in lazy parsing
          */
-        string stringifyObject() const;
-        string stringifyArray() const;
+        static Json parse(string_view text, const shared_ptr<const void>& input,
+            vector<string>& diagnostics, const ParseOptions&);
+
+        /**
+         * Splits a sequence of values at the end of each value
+         */
+        static vector<string_view> splitRecords(string_view);
+
+        /**
+         * Parses the elements of a top-level array in parallel, returns
+         * false if the <text> has to be parsed serially (not a big array,
+         * less than 2 threads, local ownership). After a malformed element
+         * the rest of the array is parsed serially, for its diagnostics
+         */
+        static bool parseArrayParallel(string_view text, const ParseOptions&, vector<string>& diagnostics, Json& result);
+
+        /**
+         * The string value (stored inline or not)
+         */
+        string_view stringView() const;
+
+        void setString(const string_view&, pmr::memory_resource* resource = heap());
 
         /*********************** Public members ***********************/        
         public: 
 
+        /**
+         * The default memory of the values: the global operator new
+         */
+        static pmr::memory_resource* heap();
+
+        /**
+         * Memory of the string or container, heap() for the values
+         * stored inline (children may live somewhere else)
+         */
+        pmr::memory_resource* resource() const;
+
         /**
          *  Default constructor - undefined value initialized
          */
@@ -188,6 +368,7 @@ namespace JsonSer
         Json(const double&);
         /**
          *  Constructor - _float value initialized
+         *  (stored as a double)
          */
         Json(const long double&);
         /**
@@ -199,49 +380,116 @@ namespace JsonSer
          */
         Json(const char*);
         /**
-         *  Constructor - _string value initialized
+         *  Constructor - _string value initialized (the chars of a
+         *  long string are copied next to its HeapString, from the
+         *  resource of a pmr::string)
          */
         Json(const string&);
+        Json(string&&);
+        Json(pmr::string&&);
         /**
          *  Constructor - _object value initialized
+         *  (an rvalue container is taken without copying,
+         *  the members of a map keep the order of the map)
          */
+        Json(const Object&);
+        Json(Object&&);
         Json(const unordered_map<string, Json>&);
+        Json(unordered_map<string, Json>&&);
         /**
          *  Constructor - _array value initialized
+         *  (an rvalue container is taken without copying)
          */
         Json(const vector<Json>&);
+        Json(vector<Json>&&);
+        Json(Array&&);
 
         ~Json();
         Json(const Json&);
         Json& operator=(const Json&);
+        /**
+         * A moved-from Json is undefined
+         */
+        Json(Json&&) noexcept;
+        Json& operator=(Json&&) noexcept;
+
+        /**
+         * Array mutators, they return the appended value
+         * (the json itself when it isn't an array)
+         */
+        Json& push_back(const Json&);
+        Json& push_back(Json&&);
+        template<class... Args>
+        Json& emplace_back(Args&&...);
+
+        /**
+         * Object mutators, they return the value of the key
+         * (the json itself when it isn't an object)
+         * <set> replaces the value of an existing key, <emplace> keeps it
+         */
+        Json& set(Key key, Json value);
+        template<class... Args>
+        Json& emplace(Key key, Args&&...);
 
         /**
          * Accessing operators
          */
         Json& operator[](int i);
         Json& operator[](const char* key);
-        Json& operator[](string key);
+        Json& operator[](const string& key);
 
-        operator int () { return (_impl->_type == JsonType::Int) ? _impl->_int : 0; }
-        operator long long () { return (_impl->_type == JsonType::Int) ? _impl->_int : 0; }
-        operator double () { return (_impl->_type == JsonType::Float) ? _impl->_float : 0; }
-        operator long double () { return (_impl->_type == JsonType::Float) ? _impl->_float : 0; }
-        operator bool () { return (_impl->_type == JsonType::Bool) ? _impl->_bool : false; }
-        operator string () { return (_impl->_type == JsonType::String) ? *_impl->_string : ""; }
+        operator int () { return (_type == JsonType::Int) ? (int)load<long long>() : 0; }
+        operator long long () { return (_type == JsonType::Int) ? load<long long>() : 0; }
+        operator double () { return (_type == JsonType::Float) ? load<double>() : 0; }
+        operator long double () { return (_type == JsonType::Float) ? load<double>() : 0; }
+        operator bool () { return (_type == JsonType::Bool) ? load<bool>() : false; }
+        operator string () { return (_type == JsonType::String) ? string(stringView()) : ""; }
 
         /**
-         * Getting a json from string
+         * Getting a json from string, the diagnostics of the parsing go
+         * to <diagnostics> (anything but whitespace after the value too)
+         */
+        static Json fromString(string_view);
+        static Json fromString(string_view, const ParseOptions&);
+        static Json fromString(string_view, vector<string>& diagnostics, const ParseOptions& = ParseOptions());
+        static Json fromString(const char*, size_t);
+        /**
+         * Getting a json from a file, the file is mapped
+         * in memory and parsed in place
+         */
+        static Json fromFile(const string&);
+        static Json fromFile(const string&, vector<string>& diagnostics, const ParseOptions& = ParseOptions());
+        /**
+         * Getting every value of a sequence of values (NDJSON or
+         * concatenated documents), the values are parsed in parallel
+         * and returned in the order of the input (always shared)
          */
-        static Json fromString(const string&);
+        static vector<Record> parseMany(string_view, const ParseOptions& = ParseOptions());
         /**
          * Getting a string from json
          */
         string toString() const;
+        /**
+         * Binary encodings: CBOR (RFC 8949) and MessagePack, Undefined is
+         * the CBOR undefined value and a MessagePack extension. Decoding
+         * takes the same options as fromString (lazy and threads are ignored)
+         */
+        string toCBOR() const;
+        string toMessagePack() const;
+        static Json fromCBOR(string_view);
+        static Json fromCBOR(string_view, vector<string>& diagnostics, const ParseOptions& = ParseOptions());
+        static Json fromMessagePack(string_view);
+        static Json fromMessagePack(string_view, vector<string>& diagnostics, const ParseOptions& = ParseOptions());
 
         /**
-         * Returns any diagnostic
+         * Converts a local tree so that it can be handed to other threads,
+         * only the thread that owns the tree can do it (false otherwise)
+         */
+        bool share();
+        /**
+         * Returns false if a part of the tree is still local
          */
-        vector<string>& Diagnostics() { return _diagnostics; }
+        bool isShared() const;
 
         /**
          * Comparation
@@ -274,6 +522,436 @@ namespace JsonSer
     
     };
 
+    /**
+     * A value of a sequence and the diagnostics of its parsing
+     */
+    struct Json::Record
+    {
+        Json value;
+        vector<string> diagnostics;
+    };
+
+    /**
+     * An immutable object key, 8 bytes
+     *
+     * A key of at most INLINE_KEY chars is stored in the handle itself.
+     * A longer key is a handle to a reference counted block holding its
+     * text and its hash; keys interned by the parser share that block
+     * across all the objects of a document. Comparing two keys checks the
+     * handles, then the hashes of the blocks, and only then the text
+     */
+    class Json::Key {
+
+        /**
+         * A key longer than INLINE_KEY chars. The resource is kept
+         * right before the block, unless it is Json::heap()
+         */
+        struct Data
+        {
+            atomic<uint32_t> _references;
+            uint32_t _length;
+            size_t _hash;
+            char _text[1];
+        };
+
+        static const uint32_t OWN_RESOURCE = 0x80000000;
+        static const size_t RESOURCE_PREFIX = (sizeof(pmr::memory_resource*) + alignof(Data) - 1) / alignof(Data) * alignof(Data);
+
+        /**
+         * An inline key has its length (shifted, with the low bit set)
+         * in the first byte and its chars after it. A block key has a
+         * pointer to the block (the low bit of an aligned pointer is
+         * 0 on a little endian cpu). The empty key is all zeros
+         */
+        alignas(8) char _handle[8];
+
+        bool isInline() const { return _handle[0] & 1; }
+        Data* data() const {
+            Data* data;
+            memcpy(&data, _handle, sizeof(data));
+            return isInline() ? nullptr : data;
+        }
+
+        static Data* create(string_view, pmr::memory_resource*);
+        void release();
+
+        public: /**************** public members ****************/
+
+        static const size_t INLINE_KEY = sizeof(_handle) - 1;
+
+        Key() :_handle() { }
+        Key(string_view text) :Key(text, Json::heap()) { }
+        Key(string_view, pmr::memory_resource*);
+        Key(const string& text) :Key(string_view(text)) { }
+        Key(const char* text) :Key(string_view(text)) { }
+
+        ~Key() { release(); }
+        Key(const Key&);
+        Key& operator=(const Key&);
+        Key(Key&& other) noexcept {
+            memcpy(_handle, other._handle, sizeof(_handle));
+            memset(other._handle, 0, sizeof(other._handle));
+        }
+        Key& operator=(Key&&) noexcept;
+
+        string_view view() const {
+            if (isInline())
+                return string_view(_handle + 1, (uint8_t)_handle[0] >> 1);
+            Data* block = data();
+            return block ? string_view(block->_text, block->_length & ~OWN_RESOURCE) : string_view();
+        }
+        operator string_view() const { return view(); }
+        size_t size() const { return view().size(); }
+
+        /**
+         * The hash of an inline key is computed, the one of a block is stored
+         */
+        size_t hash() const {
+            Data* block = data();
+            return block ? block->_hash : hashOf(view());
+        }
+
+        /**
+         * Returns true if the key is the <text> (whose hash is <hash>)
+         */
+        bool matches(string_view text, size_t hash) const {
+            Data* block = data();
+            return (!block || block->_hash == hash) && view() == text;
+        }
+
+        /**
+         * The hash function of the keys
+         */
+        static size_t hashOf(string_view text) { return std::hash<string_view>()(text); }
+
+        friend bool operator==(const Key& a, const Key& b) {
+            if (memcmp(a._handle, b._handle, sizeof(a._handle)) == 0)
+                return true;
+            Data* block = a.data();
+            return block && b.data() && block->_hash == b.data()->_hash && a.view() == b.view();
+        }
+        friend bool operator!=(const Key& a, const Key& b) { return !(a == b); }
+    };
+
+    /**
+     * Members of an object, in insertion order
+     *
+     * The members are stored contiguously and scanned linearly while the
+     * object is small, past INDEXED_SIZE members an open addressing index
+     * of their positions is kept next to them
+     */
+    class Json::Object {
+
+        public: /**************** public members ****************/
+
+        using Member = pair<Key, Json>;
+        using iterator = pmr::vector<Member>::iterator;
+        using const_iterator = pmr::vector<Member>::const_iterator;
+
+        private: /**************** private members ****************/
+
+        pmr::vector<Member> _members;
+
+        /**
+         * Positions + 1 of the members by hash (0 is an empty slot),
+         * empty while the object is small
+         */
+        pmr::vector<uint32_t> _index;
+
+        static const size_t INDEXED_SIZE = 16;
+        static const size_t NOT_FOUND = (size_t)-1;
+
+        /**
+         * Position of the member with the <key> (and its <hash>) or NOT_FOUND
+         */
+        size_t lookup(string_view key, size_t hash) const;
+
+        /**
+         * Keeps the index up to date after a member is appended
+         */
+        void indexLast();
+        void rebuildIndex();
+
+        public:
+
+        /**
+         * The members are allocated from the <resource>, a copy
+         * uses Json::heap() unless it is given another one
+         */
+        Object() :Object(Json::heap()) { }
+        explicit Object(pmr::memory_resource* resource) :_members(resource), _index(resource) { }
+        Object(const Object& other) :Object(other, Json::heap()) { }
+        Object(const Object& other, pmr::memory_resource* resource) :_members(other._members, resource), _index(other._index, resource) { }
+        Object(Object&&) noexcept = default;
+        Object& operator=(const Object&) = default;
+        Object& operator=(Object&&) = default;
+
+        pmr::memory_resource* resource() const { return _members.get_allocator().resource(); }
+
+        size_t size() const { return _members.size(); }
+        bool empty() const { return _members.empty(); }
+        void reserve(size_t size) { _members.reserve(size); }
+
+        iterator begin() { return _members.begin(); }
+        iterator end() { return _members.end(); }
+        const_iterator begin() const { return _members.begin(); }
+        const_iterator end() const { return _members.end(); }
+
+        /**
+         * Lookup, <at> throws out_of_range if the key is missing
+         */
+        iterator find(string_view key);
+        const_iterator find(string_view key) const;
+        Json& at(string_view key);
+        const Json& at(string_view key) const;
+        /**
+         * Lookup with the hash of the <key> already known
+         */
+        iterator find(string_view key, size_t hash);
+
+        /**
+         * Insertion, an existing key keeps its value
+         * except for <insert_or_assign>
+         */
+        template<class... Args>
+        pair<iterator, bool> try_emplace(Key key, Args&&... args);
+        pair<iterator, bool> insert(const Member& member) { return try_emplace(member.first, member.second); }
+        pair<iterator, bool> insert_or_assign(Key key, Json value);
+    };
+
+    template<class... Args>
+    pair<Json::Object::iterator, bool> Json::Object::try_emplace(Key key, Args&&... args) {
+        size_t position = lookup(key, key.hash());
+        if (position != NOT_FOUND)
+            return { _members.begin() + position, false };
+
+        _members.emplace_back(piecewise_construct,
+            forward_as_tuple(std::move(key)), forward_as_tuple(std::forward<Args>(args)...));
+        indexLast();
+        return { _members.end() - 1, true };
+    }
+
+    /**
+     * Fields of every heap value, 24 bytes
+     */
+    struct Json::HeapHeader
+    {
+        /**
+         * Number of Json sharing the value
+         */
+        atomic<uint32_t> _references;
+
+        /**
+         * Type of the Json
+         */
+        JsonType _type;
+
+        /**
+         * Ownership policy, a local value is only
+         * touched by the <_owner> thread
+         */
+        Ownership _ownership;
+
+        /**
+         * A lazy container is parsed by the first thread that
+         * accesses it, the others wait for it to be ready. It
+         * shares the padding of the fields above, a string is
+         * always ready
+         */
+        static const uint8_t READY = 0, LAZY = 1, PARSING = 2;
+        atomic<uint8_t> _state;
+
+        thread::id _owner;
+
+        /**
+         * Memory of the value
+         */
+        pmr::memory_resource* _resource;
+
+        HeapHeader(pmr::memory_resource* resource, JsonType type, uint8_t state = READY)
+            :_references(1), _type(type), _ownership(Ownership::Shared), _state(state), _resource(resource) { }
+    };
+
+    /**
+     * A string longer than SHORT_STRING, its chars follow
+     * it in the same allocation (32 bytes plus the chars)
+     */
+    struct Json::HeapString : Json::HeapHeader
+    {
+        size_t _length;
+
+        HeapString(pmr::memory_resource* resource, const size_t& length)
+            :HeapHeader(resource, JsonType::String), _length(length) { }
+
+        string_view view() const { return string_view((const char*)(this + 1), _length); }
+
+        /**
+         * A string allocated from the <resource>, destroy()
+         * gives its memory back to the same resource
+         */
+        static HeapString* create(pmr::memory_resource* resource, const string_view& value);
+        static void destroy(HeapString*);
+    };
+
+    /**
+     * Heap storage of objects and arrays
+     */
+    struct Json::Impl : Json::HeapHeader
+    {
+        /**
+         * The text of a lazy container and the owner of the input
+         */
+        struct Source
+        {
+            shared_ptr<const void> input;
+            string_view text;
+        };
+
+        /**
+         * The value of the json 
+         */
+        union 
+        {
+            Object _object;
+            Array _array;
+            Source _source;
+        };
+
+        /**
+         * The value is copied into the <resource> (or
+         * taken when it is already allocated from it)
+         */
+        Impl(pmr::memory_resource*, const Object&);
+        Impl(pmr::memory_resource*, Object&&);
+        Impl(pmr::memory_resource*, const vector<Json>&);
+        Impl(pmr::memory_resource*, vector<Json>&&);
+        Impl(pmr::memory_resource*, Array&&);
+        Impl(pmr::memory_resource*, JsonType, const Source&);
+
+        ~Impl();
+
+        /**
+         * An Impl allocated from the <resource>, destroy()
+         * gives its memory back to the same resource
+         */
+        template<class... Args>
+        static Impl* create(pmr::memory_resource* resource, Args&&... args);
+        static void destroy(Impl*);
+
+        /**
+         * Parses a lazy container (one level, the
+         * containers inside it are lazy too)
+         */
+        void materialize();
+    };
+
+    template<class... Args>
+    Json& Json::emplace_back(Args&&... args) {
+        if (_type != JsonType::Array)
+            return *this;
+        return container()->_array.emplace_back(std::forward<Args>(args)...);
+    }
+
+    template<class... Args>
+    Json& Json::emplace(Key key, Args&&... args) {
+        if (_type != JsonType::Object)
+            return *this;
+        return container()->_object.try_emplace(std::move(key), std::forward<Args>(args)...).first->second;
+    }
+
+    /**
+     * The keys and strings of a document being parsed,
+     * an open addressing table of the texts by hash
+     */
+    class Json::KeyPool {
+
+        vector<Key> _keys;
+        size_t _size = 0;
+
+        unordered_map<string_view, Json> _strings;
+
+        /**
+         * Memory of the keys and strings
+         */
+        pmr::memory_resource* _resource;
+
+        void grow();
+
+        public: /**************** public members ****************/
+
+        KeyPool(pmr::memory_resource* resource) :_resource(resource) { }
+
+        /**
+         * Returns the key of the pool with the <text>,
+         * the key is added if there is none
+         */
+        Key intern(string_view text);
+
+        /**
+         * Returns the string of the pool with the <text>,
+         * (set into <json>), the string is added if there is none
+         */
+        void internString(string_view text, Json& json);
+    };
+
+    /**
+     * Builds a Json tree from the events of a JsonReader
+     */
+    class Json::TreeBuilder {
+
+        /**
+         * Containers being built and the
+         * pending key of each one of them
+         */
+        vector<Json> _stack;
+        vector<Key> _keys;
+
+        Json _root;
+
+        ParseOptions _options;
+        pmr::memory_resource* _resource;
+        KeyPool _pool;
+
+        /**
+         * Owner of the input of lazy containers
+         */
+        shared_ptr<const void> _input;
+
+        /**
+         * Adds a value to the innermost container
+         */
+        bool add(Json&&);
+
+        public: /**************** public members ****************/
+
+        TreeBuilder(const ParseOptions& options = ParseOptions(), const shared_ptr<const void>& input = nullptr)
+            :_options(options), _resource(options.resource ? options.resource : heap()), _pool(_resource), _input(input) { }
+
+        bool onNull();
+        bool onUndefined();
+        bool onInt(long long);
+        bool onFloat(double);
+        bool onBool(bool);
+        bool onString(string_view);
+        bool onStartObject();
+        bool onKey(string_view);
+        bool onEndObject(size_t);
+        bool onStartArray();
+        bool onEndArray(size_t);
+        bool onSkipped(string_view);
+
+        /**
+         * The parsed value
+         */
+        Json& Root() { return _root; }
+
+        /**
+         * Takes the parsed value, the builder can be used for another
+         * value (sharing the keys of the previous ones)
+         */
+        Json Take() { _stack.clear(); _keys.clear(); return std::move(_root); }
+    };
+
     /**
      * Helper functions for creating a json
     */
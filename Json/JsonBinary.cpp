@@ -0,0 +1,314 @@
+#include "JsonBinary.h"
+
+#include <cmath>
+
+namespace JsonSer
+{
+
+    /************************** Binary Writer ********************************/
+
+    void BinaryWriter::flushIfFull() {
+        if (_stream && _buffer.size() >= FLUSH_SIZE)
+            flush();
+    }
+
+    void BinaryWriter::flush() {
+        if (!_stream || _buffer.empty())
+            return;
+
+        _stream->write(_buffer.data(), _buffer.size());
+        _buffer.clear();
+    }
+
+    void BinaryWriter::putByte(const uint8_t& byte) {
+        target().push_back((char)byte);
+    }
+
+    void BinaryWriter::putBigEndian(const uint64_t& value, const size_t& bytes) {
+        char data[8];
+        for (size_t i = 0; i < bytes; i++)
+            data[i] = (char)(value >> (8 * (bytes - 1 - i)));
+        target().append(data, bytes);
+    }
+
+    void BinaryWriter::putBytes(const string_view& bytes) {
+        target().append(bytes);
+        flushIfFull();
+    }
+
+
+    /************************** Cbor Writer ********************************/
+
+    /**
+     * The argument goes in the initial byte below 24,
+     * otherwise in the next 1, 2, 4 or 8 bytes
+     */
+    void CborWriter::head(const uint8_t& major, const uint64_t& argument) {
+        uint8_t initial = major << 5;
+
+        if (argument < 24)
+            return putByte(initial | (uint8_t)argument);
+
+        if (argument <= 0xff) {
+            putByte(initial | 24);
+            return putBigEndian(argument, 1);
+        }
+        if (argument <= 0xffff) {
+            putByte(initial | 25);
+            return putBigEndian(argument, 2);
+        }
+        if (argument <= 0xffffffff) {
+            putByte(initial | 26);
+            return putBigEndian(argument, 4);
+        }
+        putByte(initial | 27);
+        putBigEndian(argument, 8);
+    }
+
+    void CborWriter::writeNull() { putByte(0xf6); flushIfFull(); }
+    void CborWriter::writeUndefined() { putByte(0xf7); flushIfFull(); }
+    void CborWriter::writeBool(bool value) { putByte(value ? 0xf5 : 0xf4); flushIfFull(); }
+
+    /**
+     * A negative n is written as -1 - n (major type 1)
+     */
+    void CborWriter::writeInt(long long value) {
+        if (value >= 0)
+            head(0, (uint64_t)value);
+        else
+            head(1, ~(uint64_t)value);
+        flushIfFull();
+    }
+
+    void CborWriter::writeFloat(double value) {
+        float single = (float)value;
+
+        if ((double)single == value) {
+            uint32_t bits;
+            memcpy(&bits, &single, sizeof(bits));
+            putByte(0xfa);
+            putBigEndian(bits, 4);
+        }
+        else {
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            putByte(0xfb);
+            putBigEndian(bits, 8);
+        }
+        flushIfFull();
+    }
+
+    void CborWriter::writeString(string_view value) {
+        head(3, value.size());
+        putBytes(value);
+    }
+
+    void CborWriter::startObject(size_t members) { head(5, members); }
+    void CborWriter::startArray(size_t elements) { head(4, elements); }
+    void CborWriter::key(string_view name) { writeString(name); }
+
+    void CborWriter::startObject() { putByte(0xbf); }
+    void CborWriter::startArray() { putByte(0x9f); }
+    void CborWriter::end() { putByte(0xff); flushIfFull(); }
+
+    void CborWriter::write(const Json& json) {
+        switch (json._type) {
+            case Json::JsonType::Undefined: return writeUndefined();
+            case Json::JsonType::Null: return writeNull();
+            case Json::JsonType::Int: return writeInt(json.load<long long>());
+            case Json::JsonType::Float: return writeFloat(json.load<double>());
+            case Json::JsonType::Bool: return writeBool(json.load<bool>());
+            case Json::JsonType::String: return writeString(json.stringView());
+            case Json::JsonType::Object: {
+                const auto& object = json.container()->_object;
+                startObject(object.size());
+                for (const auto& kv : object) {
+                    key(kv.first);
+                    write(kv.second);
+                }
+                return;
+            }
+            case Json::JsonType::Array: {
+                const auto& array = json.container()->_array;
+                startArray(array.size());
+                for (const auto& e : array)
+                    write(e);
+                return;
+            }
+        }
+    }
+
+
+    /************************** Message Pack Writer ********************************/
+
+    /**
+     * A fixed head when <size> is below <fixedLimit>, otherwise
+     * <sized> with 2 bytes of size or the next head with 4
+     */
+    void MessagePackWriter::head(const uint8_t& fixed, const uint8_t& fixedLimit, const uint8_t& sized, const uint64_t& size) {
+        if (size < fixedLimit)
+            return putByte(fixed | (uint8_t)size);
+
+        if (size <= 0xffff) {
+            putByte(sized);
+            return putBigEndian(size, 2);
+        }
+        putByte(sized + 1);
+        putBigEndian(size, 4);
+    }
+
+    void MessagePackWriter::writeNull() { putByte(0xc0); flushIfFull(); }
+    void MessagePackWriter::writeBool(bool value) { putByte(value ? 0xc3 : 0xc2); flushIfFull(); }
+
+    void MessagePackWriter::writeUndefined() {
+        putByte(0xd4);
+        putByte((uint8_t)UNDEFINED_EXTENSION);
+        putByte(0);
+        flushIfFull();
+    }
+
+    /**
+     * Fixints, then the smallest signed or unsigned integer
+     */
+    void MessagePackWriter::writeInt(long long value) {
+        if (value >= -32 && value <= 0x7f)
+            putByte((uint8_t)value);
+        else if (value > 0) {
+            if (value <= 0xff) { putByte(0xcc); putBigEndian(value, 1); }
+            else if (value <= 0xffff) { putByte(0xcd); putBigEndian(value, 2); }
+            else if (value <= 0xffffffffLL) { putByte(0xce); putBigEndian(value, 4); }
+            else { putByte(0xcf); putBigEndian(value, 8); }
+        }
+        else {
+            if (value >= -0x80) { putByte(0xd0); putBigEndian((uint64_t)value, 1); }
+            else if (value >= -0x8000) { putByte(0xd1); putBigEndian((uint64_t)value, 2); }
+            else if (value >= -0x80000000LL) { putByte(0xd2); putBigEndian((uint64_t)value, 4); }
+            else { putByte(0xd3); putBigEndian((uint64_t)value, 8); }
+        }
+        flushIfFull();
+    }
+
+    void MessagePackWriter::writeFloat(double value) {
+        float single = (float)value;
+
+        if ((double)single == value) {
+            uint32_t bits;
+            memcpy(&bits, &single, sizeof(bits));
+            putByte(0xca);
+            putBigEndian(bits, 4);
+        }
+        else {
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            putByte(0xcb);
+            putBigEndian(bits, 8);
+        }
+        flushIfFull();
+    }
+
+    void MessagePackWriter::writeString(string_view value) {
+        if (value.size() >= 32 && value.size() <= 0xff) {
+            putByte(0xd9);
+            putBigEndian(value.size(), 1);
+        }
+        else
+            head(0xa0, 32, 0xda, value.size());
+        putBytes(value);
+    }
+
+    void MessagePackWriter::startObject(size_t members) { head(0x80, 16, 0xde, members); }
+    void MessagePackWriter::startArray(size_t elements) { head(0x90, 16, 0xdc, elements); }
+    void MessagePackWriter::key(string_view name) { writeString(name); }
+
+    void MessagePackWriter::write(const Json& json) {
+        switch (json._type) {
+            case Json::JsonType::Undefined: return writeUndefined();
+            case Json::JsonType::Null: return writeNull();
+            case Json::JsonType::Int: return writeInt(json.load<long long>());
+            case Json::JsonType::Float: return writeFloat(json.load<double>());
+            case Json::JsonType::Bool: return writeBool(json.load<bool>());
+            case Json::JsonType::String: return writeString(json.stringView());
+            case Json::JsonType::Object: {
+                const auto& object = json.container()->_object;
+                startObject(object.size());
+                for (const auto& kv : object) {
+                    key(kv.first);
+                    write(kv.second);
+                }
+                return;
+            }
+            case Json::JsonType::Array: {
+                const auto& array = json.container()->_array;
+                startArray(array.size());
+                for (const auto& e : array)
+                    write(e);
+                return;
+            }
+        }
+    }
+
+
+    /************************** Binary Reader ********************************/
+
+    bool BinaryReader::stop(const size_t& position, const string& additional) {
+        if (position >= _data.size())
+            _reporter.ReportUnexpectedEnd(position, additional);
+        else
+            _reporter.ReportUnexpectedByte((uint8_t)_data[position], position, additional);
+
+        _failed = true;
+        _position = _data.size();
+        return false;
+    }
+
+    bool BinaryReader::readBigEndian(const size_t& bytes, uint64_t& value, const string& additional) {
+        if (bytes > _data.size() - _position)
+            return stop(_data.size(), additional);
+
+        value = 0;
+        for (size_t i = 0; i < bytes; i++)
+            value = (value << 8) | (uint8_t)_data[_position++];
+        return true;
+    }
+
+    bool BinaryReader::readBytes(const uint64_t& length, string_view& bytes, const string& additional) {
+        if (length > _data.size() - _position)
+            return stop(_data.size(), additional);
+
+        bytes = _data.substr(_position, (size_t)length);
+        _position += (size_t)length;
+        return true;
+    }
+
+    /**
+     * A half (IEEE 754 binary16), single or double precision float
+     */
+    double BinaryReader::toFloat(const uint64_t& bits, const size_t& bytes) {
+        if (bytes == 8) {
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        if (bytes == 4) {
+            uint32_t narrow = (uint32_t)bits;
+            float value;
+            memcpy(&value, &narrow, sizeof(value));
+            return value;
+        }
+
+        int exponent = (bits >> 10) & 0x1f;
+        double mantissa = (double)(bits & 0x3ff);
+        double value;
+
+        if (exponent == 0)
+            value = ldexp(mantissa, -24);
+        else if (exponent == 31)
+            value = mantissa == 0 ? numeric_limits<double>::infinity() : numeric_limits<double>::quiet_NaN();
+        else
+            value = ldexp(mantissa + 1024, exponent - 25);
+
+        return (bits & 0x8000) ? -value : value;
+    }
+
+} // namespace JsonSer
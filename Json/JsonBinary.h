@@ -0,0 +1,644 @@
+#ifndef JSON_BINARY_API
+#define JSON_BINARY_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+
+#include <cstring>
+#include <limits>
+#include <ostream>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * Output of the binary serializers
+     *
+     * Bytes are appended to the target string itself, or to a staging
+     * buffer that is flushed to an ostream when it gets full
+     */
+    class BinaryWriter {
+
+        /**
+         * Sinks, only one of them is used
+         */
+        string* _out = nullptr;
+        ostream* _stream = nullptr;
+
+        /**
+         * Staging buffer for streams
+         */
+        string _buffer;
+
+        static const size_t FLUSH_SIZE = 64 * 1024;
+
+        protected: /**************** derived members ****************/
+
+        string& target() { return _out ? *_out : _buffer; }
+
+        /**
+         * Flushes the staging buffer once it's full
+         */
+        void flushIfFull();
+
+        /**
+         * Raw output, numbers are big endian
+         */
+        void putByte(const uint8_t&);
+        void putBigEndian(const uint64_t&, const size_t& bytes);
+        void putBytes(const string_view&);
+
+        BinaryWriter(string& out) :_out(&out) {}
+        BinaryWriter(ostream& stream) :_stream(&stream) {}
+        ~BinaryWriter() { flush(); }
+
+        public: /**************** public members ****************/
+
+        BinaryWriter(const BinaryWriter&) = delete;
+        BinaryWriter& operator=(const BinaryWriter&) = delete;
+
+        /**
+         * Sends the staging buffer to the stream
+         */
+        void flush();
+    };
+
+    /**
+     * A streaming CBOR (RFC 8949) serializer
+     *
+     * Integers and lengths take the shortest head, floats are written
+     * as single precision when that is exact. Containers have a definite
+     * length, or an indefinite one (startObject(), startArray() and end())
+     * when the size isn't known in advance
+     */
+    class CborWriter : public BinaryWriter {
+
+        /**
+         * Major type and argument of a data item
+         */
+        void head(const uint8_t& major, const uint64_t& argument);
+
+        public: /**************** public members ****************/
+
+        CborWriter(string& out) :BinaryWriter(out) {}
+        CborWriter(ostream& stream) :BinaryWriter(stream) {}
+
+        /**
+         * Writes a whole value
+         */
+        void write(const Json&);
+
+        /**
+         * Writes a single value
+         */
+        void writeNull();
+        void writeUndefined();
+        void writeInt(long long);
+        void writeFloat(double);
+        void writeBool(bool);
+        void writeString(string_view);
+
+        /**
+         * Containers, an object of <members> is followed by
+         * <members> pairs of key and value
+         */
+        void startObject(size_t members);
+        void startArray(size_t elements);
+        void key(string_view);
+
+        /**
+         * Containers of indefinite length, closed by end()
+         */
+        void startObject();
+        void startArray();
+        void end();
+    };
+
+    /**
+     * A streaming MessagePack serializer
+     *
+     * Undefined is the extension UNDEFINED_EXTENSION with a single zero
+     * byte of data (fixext 1), there is no such value in MessagePack
+     */
+    class MessagePackWriter : public BinaryWriter {
+
+        /**
+         * Head of a string, an array or a map
+         * (<sized> is the head with 2 bytes of size)
+         */
+        void head(const uint8_t& fixed, const uint8_t& fixedLimit, const uint8_t& sized, const uint64_t& size);
+
+        public: /**************** public members ****************/
+
+        static const int8_t UNDEFINED_EXTENSION = 0;
+
+        MessagePackWriter(string& out) :BinaryWriter(out) {}
+        MessagePackWriter(ostream& stream) :BinaryWriter(stream) {}
+
+        /**
+         * Writes a whole value
+         */
+        void write(const Json&);
+
+        /**
+         * Writes a single value
+         */
+        void writeNull();
+        void writeUndefined();
+        void writeInt(long long);
+        void writeFloat(double);
+        void writeBool(bool);
+        void writeString(string_view);
+
+        /**
+         * Containers, an object of <members> is followed by
+         * <members> pairs of key and value
+         */
+        void startObject(size_t members);
+        void startArray(size_t elements);
+        void key(string_view);
+    };
+
+    /**
+     * Base of the binary readers: the input and the diagnostics
+     *
+     * The input is owned by the caller. After an error nothing more
+     * is read, the value being read is reported as undefined and the
+     * open containers are closed, so the handler sees balanced events
+     */
+    class BinaryReader {
+
+        protected: /**************** derived members ****************/
+
+        string_view _data;
+        size_t _position = 0;
+
+        Json::Reporter _reporter;
+        bool _failed = false;
+
+        /**
+         * Chunks of a string that isn't contiguous in the input
+         */
+        string _chunks;
+
+        BinaryReader(string_view data) :_data(data) {}
+
+        /**
+         * Reports the byte at <position> (or the end of
+         * the input) and stops reading, returns false
+         */
+        bool stop(const size_t& position, const string& additional);
+
+        /**
+         * Reads a big endian number of <bytes>
+         */
+        bool readBigEndian(const size_t& bytes, uint64_t& value, const string& additional);
+
+        /**
+         * Reads <length> bytes
+         */
+        bool readBytes(const uint64_t& length, string_view& bytes, const string& additional);
+
+        static double toFloat(const uint64_t& bits, const size_t& bytes);
+
+        public: /**************** public members ****************/
+
+        /**
+         * Returns true if the whole input was read
+         */
+        bool isAtEnd() const { return _position >= _data.size(); }
+
+        vector<string>& Diagnostics() { return _reporter.Diagnostics(); }
+    };
+
+    /**
+     * A CBOR reader, data items are reported to a JsonHandler
+     *
+     * Text and byte strings are strings (views of the input unless they
+     * have an indefinite length), tags are ignored, maps need string keys
+     * and integers out of the range of long long are floats
+     */
+    template<class Handler>
+    class CborReader : public BinaryReader {
+
+        Handler& _handler;
+
+        /**
+         * Argument of the head of a data item
+         */
+        bool readArgument(const uint8_t& info, uint64_t& argument);
+
+        /**
+         * A text or byte string, the chunks of an
+         * indefinite length string are joined
+         */
+        bool readString(const uint8_t& major, const uint8_t& info, string_view& text);
+
+        /**
+         * Parsers, they return false when
+         * the handler stops the parsing
+         */
+        bool parseObject(const uint8_t& info);
+        bool parseArray(const uint8_t& info);
+        bool parseSimple(const uint8_t& info);
+
+        public: /**************** public members ****************/
+
+        CborReader(string_view data, Handler& handler) :BinaryReader(data), _handler(handler) {}
+
+        /**
+         * Parses one data item, returns false
+         * if the handler stopped the parsing
+         */
+        bool parse();
+    };
+
+    /**
+     * A MessagePack reader, values are reported to a JsonHandler
+     *
+     * Strings and binaries are strings (views of the input), maps need
+     * string keys, the only extension is UNDEFINED_EXTENSION
+     */
+    template<class Handler>
+    class MessagePackReader : public BinaryReader {
+
+        Handler& _handler;
+
+        /**
+         * Parsers, they return false when
+         * the handler stops the parsing
+         */
+        bool parseObject(const uint64_t& members);
+        bool parseArray(const uint64_t& elements);
+        bool parseString(const uint64_t& length);
+        bool parseExtension(const uint64_t& length);
+
+        public: /**************** public members ****************/
+
+        MessagePackReader(string_view data, Handler& handler) :BinaryReader(data), _handler(handler) {}
+
+        /**
+         * Parses one value, returns false
+         * if the handler stopped the parsing
+         */
+        bool parse();
+    };
+
+
+    /************************** Cbor Reader **************************/
+
+    template<class Handler>
+    bool CborReader<Handler>::readArgument(const uint8_t& info, uint64_t& argument) {
+        if (info < 24) {
+            argument = info;
+            return true;
+        }
+
+        if (info > 27)
+            return stop(_position - 1, "Argument of a data item");
+
+        return readBigEndian((size_t)1 << (info - 24), argument, "Argument of a data item");
+    }
+
+    template<class Handler>
+    bool CborReader<Handler>::readString(const uint8_t& major, const uint8_t& info, string_view& text) {
+        uint64_t length;
+
+        if (info != 31)
+            return readArgument(info, length) && readBytes(length, text, "Content of a string");
+
+        _chunks.clear();
+        while (true) {
+            if (_position >= _data.size())
+                return stop(_position, "Chunk of a string");
+
+            uint8_t initial = (uint8_t)_data[_position];
+            if (initial == 0xff) {
+                _position++;
+                text = _chunks;
+                return true;
+            }
+
+            if (initial >> 5 != major || (initial & 31) == 31)
+                return stop(_position, "Chunk of a string");
+            _position++;
+
+            string_view chunk;
+            if (!readArgument(initial & 31, length) || !readBytes(length, chunk, "Content of a string"))
+                return false;
+            _chunks.append(chunk);
+        }
+    }
+
+    template<class Handler>
+    bool CborReader<Handler>::parseObject(const uint8_t& info) {
+        uint64_t members = 0;
+        size_t count = 0;
+
+        if (info != 31 && !readArgument(info, members))
+            return _handler.onUndefined();
+
+        if (!_handler.onStartObject())
+            return false;
+
+        while (!_failed && (info == 31 || count < members)) {
+            if (info == 31 && _position < _data.size() && (uint8_t)_data[_position] == 0xff) {
+                _position++;
+                break;
+            }
+
+            if (_position >= _data.size()) {
+                stop(_position, "Key of a map");
+                break;
+            }
+
+            uint8_t initial = (uint8_t)_data[_position];
+            if (initial >> 5 != 2 && initial >> 5 != 3) {
+                stop(_position, "Key of a map (a string)");
+                break;
+            }
+            _position++;
+
+            string_view key;
+            if (!readString(initial >> 5, initial & 31, key))
+                break;
+
+            if (!_handler.onKey(key) || !parse())
+                return false;
+            count++;
+        }
+
+        return _handler.onEndObject(count);
+    }
+
+    template<class Handler>
+    bool CborReader<Handler>::parseArray(const uint8_t& info) {
+        uint64_t elements = 0;
+        size_t count = 0;
+
+        if (info != 31 && !readArgument(info, elements))
+            return _handler.onUndefined();
+
+        if (!_handler.onStartArray())
+            return false;
+
+        while (!_failed && (info == 31 || count < elements)) {
+            if (info == 31 && _position < _data.size() && (uint8_t)_data[_position] == 0xff) {
+                _position++;
+                break;
+            }
+
+            if (!parse())
+                return false;
+            count++;
+        }
+
+        return _handler.onEndArray(count);
+    }
+
+    /**
+     * Major type 7: simple values and floats
+     */
+    template<class Handler>
+    bool CborReader<Handler>::parseSimple(const uint8_t& info) {
+        uint64_t bits;
+
+        switch (info) {
+            case 20: return _handler.onBool(false);
+            case 21: return _handler.onBool(true);
+            case 22: return _handler.onNull();
+            case 23: return _handler.onUndefined();
+            case 25:
+            case 26:
+            case 27: {
+                size_t bytes = (size_t)1 << (info - 24);
+                if (!readBigEndian(bytes, bits, "Content of a float"))
+                    return _handler.onUndefined();
+                return _handler.onFloat(toFloat(bits, bytes));
+            }
+        }
+
+        stop(_position - 1, "Simple value");
+        return _handler.onUndefined();
+    }
+
+    template<class Handler>
+    bool CborReader<Handler>::parse() {
+        if (_position >= _data.size()) {
+            stop(_position, "Any data item");
+            return _handler.onUndefined();
+        }
+
+        uint8_t initial = (uint8_t)_data[_position++];
+        uint8_t major = initial >> 5;
+        uint8_t info = initial & 31;
+        uint64_t argument;
+
+        switch (major) {
+            case 0:
+                if (!readArgument(info, argument))
+                    return _handler.onUndefined();
+                if (argument > (uint64_t)numeric_limits<long long>::max())
+                    return _handler.onFloat((double)argument);
+                return _handler.onInt((long long)argument);
+
+            case 1:
+                if (!readArgument(info, argument))
+                    return _handler.onUndefined();
+                if (argument > (uint64_t)numeric_limits<long long>::max())
+                    return _handler.onFloat(-1.0 - (double)argument);
+                return _handler.onInt(-1 - (long long)argument);
+
+            case 2:
+            case 3: {
+                string_view text;
+                if (!readString(major, info, text))
+                    return _handler.onUndefined();
+                return _handler.onString(text);
+            }
+
+            case 4:
+                return parseArray(info);
+
+            case 5:
+                return parseObject(info);
+
+            case 6:
+                if (!readArgument(info, argument))
+                    return _handler.onUndefined();
+                return parse();
+        }
+
+        return parseSimple(info);
+    }
+
+
+    /************************** Message Pack Reader **************************/
+
+    template<class Handler>
+    bool MessagePackReader<Handler>::parseObject(const uint64_t& members) {
+        size_t count = 0;
+
+        if (!_handler.onStartObject())
+            return false;
+
+        while (!_failed && count < members) {
+            if (_position >= _data.size()) {
+                stop(_position, "Key of a map");
+                break;
+            }
+
+            uint8_t initial = (uint8_t)_data[_position];
+            uint64_t length;
+
+            if (initial >= 0xa0 && initial <= 0xbf) {
+                _position++;
+                length = initial & 0x1f;
+            }
+            else if (initial >= 0xd9 && initial <= 0xdb) {
+                _position++;
+                if (!readBigEndian((size_t)1 << (initial - 0xd9), length, "Length of a string"))
+                    break;
+            }
+            else {
+                stop(_position, "Key of a map (a string)");
+                break;
+            }
+
+            string_view key;
+            if (!readBytes(length, key, "Content of a string"))
+                break;
+
+            if (!_handler.onKey(key) || !parse())
+                return false;
+            count++;
+        }
+
+        return _handler.onEndObject(count);
+    }
+
+    template<class Handler>
+    bool MessagePackReader<Handler>::parseArray(const uint64_t& elements) {
+        size_t count = 0;
+
+        if (!_handler.onStartArray())
+            return false;
+
+        while (!_failed && count < elements) {
+            if (!parse())
+                return false;
+            count++;
+        }
+
+        return _handler.onEndArray(count);
+    }
+
+    template<class Handler>
+    bool MessagePackReader<Handler>::parseString(const uint64_t& length) {
+        string_view text;
+        if (!readBytes(length, text, "Content of a string"))
+            return _handler.onUndefined();
+        return _handler.onString(text);
+    }
+
+    template<class Handler>
+    bool MessagePackReader<Handler>::parseExtension(const uint64_t& length) {
+        uint64_t type;
+        size_t position = _position;
+        string_view data;
+
+        if (!readBigEndian(1, type, "Type of an extension") || !readBytes(length, data, "Data of an extension"))
+            return _handler.onUndefined();
+
+        if ((int8_t)type != MessagePackWriter::UNDEFINED_EXTENSION)
+            stop(position, "Type of an extension");
+        return _handler.onUndefined();
+    }
+
+    template<class Handler>
+    bool MessagePackReader<Handler>::parse() {
+        if (_position >= _data.size()) {
+            stop(_position, "Any value");
+            return _handler.onUndefined();
+        }
+
+        uint8_t initial = (uint8_t)_data[_position++];
+        uint64_t value;
+
+        if (initial <= 0x7f)
+            return _handler.onInt(initial);
+        if (initial >= 0xe0)
+            return _handler.onInt((int8_t)initial);
+        if (initial <= 0x8f)
+            return parseObject(initial & 0x0f);
+        if (initial <= 0x9f)
+            return parseArray(initial & 0x0f);
+        if (initial <= 0xbf)
+            return parseString(initial & 0x1f);
+
+        /**
+         * Values with a size: 1 << (initial - first) bytes
+         */
+        auto sized = [&](const uint8_t& first, const string& additional) {
+            return readBigEndian((size_t)1 << (initial - first), value, additional);
+        };
+
+        switch (initial) {
+            case 0xc0: return _handler.onNull();
+            case 0xc2: return _handler.onBool(false);
+            case 0xc3: return _handler.onBool(true);
+
+            case 0xc4: case 0xc5: case 0xc6:
+                return sized(0xc4, "Length of a binary") ? parseString(value) : _handler.onUndefined();
+
+            case 0xc7: case 0xc8: case 0xc9:
+                return sized(0xc7, "Length of an extension") ? parseExtension(value) : _handler.onUndefined();
+
+            case 0xca: case 0xcb:
+                if (!sized(0xc8, "Content of a float"))
+                    return _handler.onUndefined();
+                return _handler.onFloat(toFloat(value, (size_t)1 << (initial - 0xc8)));
+
+            case 0xcc: case 0xcd: case 0xce: case 0xcf:
+                if (!sized(0xcc, "Content of an integer"))
+                    return _handler.onUndefined();
+                if (value > (uint64_t)numeric_limits<long long>::max())
+                    return _handler.onFloat((double)value);
+                return _handler.onInt((long long)value);
+
+            case 0xd0: case 0xd1: case 0xd2: case 0xd3: {
+                if (!sized(0xd0, "Content of an integer"))
+                    return _handler.onUndefined();
+
+                /**
+                 * Sign extension of the narrow integers
+                 */
+                size_t bits = (size_t)8 << (initial - 0xd0);
+                if (bits < 64 && (value >> (bits - 1)))
+                    value |= ~(uint64_t)0 << bits;
+                return _handler.onInt((long long)value);
+            }
+
+            case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+                return parseExtension((uint64_t)1 << (initial - 0xd4));
+
+            case 0xd9: case 0xda: case 0xdb:
+                return sized(0xd9, "Length of a string") ? parseString(value) : _handler.onUndefined();
+
+            case 0xdc: case 0xdd:
+                return sized(0xdb, "Length of an array") ? parseArray(value) : _handler.onUndefined();
+
+            case 0xde: case 0xdf:
+                return sized(0xdd, "Length of a map") ? parseObject(value) : _handler.onUndefined();
+        }
+
+        stop(_position - 1, "Any value");
+        return _handler.onUndefined();
+    }
+
+} // namespace JsonSer
+
+#endif
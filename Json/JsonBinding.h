@@ -0,0 +1,359 @@
+#ifndef JSON_BINDING_API
+#define JSON_BINDING_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+#include "JsonCursor.h"
+#include "JsonWriter.h"
+
+#include <limits>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+
+/**
+ * Binds the public members of a struct, written after the
+ * struct in its namespace (up to 32 members):
+ *
+ *     struct Point { int x = 0; int y = 0; };
+ *     JSON_FIELDS(Point, x, y)
+ *
+ *     Point point;
+ *     JsonStruct::fromString("{\"x\":1,\"y\":2}", point);
+ *     string text = JsonStruct::toString(point);
+ */
+#define JSON_FIELDS(Type, ...) \
+    constexpr auto jsonFieldsOf(const Type*) { \
+        return std::make_tuple(JSON_FIELDS_EXPAND(JSON_FIELDS_CONCAT(JSON_FIELDS_, JSON_FIELDS_COUNT(__VA_ARGS__))(Type, __VA_ARGS__))); \
+    }
+
+/**
+ * A JsonField per member
+ */
+#define JSON_FIELDS_EXPAND(x) x
+#define JSON_FIELDS_CONCAT(a, b) JSON_FIELDS_CONCAT_(a, b)
+#define JSON_FIELDS_CONCAT_(a, b) a##b
+#define JSON_FIELDS_COUNT(...) JSON_FIELDS_EXPAND(JSON_FIELDS_NTH(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define JSON_FIELDS_NTH(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define JSON_FIELDS_1(Type, f) JsonSer::jsonField(#f, &Type::f)
+#define JSON_FIELDS_2(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_1(Type, __VA_ARGS__))
+#define JSON_FIELDS_3(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_2(Type, __VA_ARGS__))
+#define JSON_FIELDS_4(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_3(Type, __VA_ARGS__))
+#define JSON_FIELDS_5(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_4(Type, __VA_ARGS__))
+#define JSON_FIELDS_6(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_5(Type, __VA_ARGS__))
+#define JSON_FIELDS_7(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_6(Type, __VA_ARGS__))
+#define JSON_FIELDS_8(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_7(Type, __VA_ARGS__))
+#define JSON_FIELDS_9(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_8(Type, __VA_ARGS__))
+#define JSON_FIELDS_10(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_9(Type, __VA_ARGS__))
+#define JSON_FIELDS_11(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_10(Type, __VA_ARGS__))
+#define JSON_FIELDS_12(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_11(Type, __VA_ARGS__))
+#define JSON_FIELDS_13(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_12(Type, __VA_ARGS__))
+#define JSON_FIELDS_14(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_13(Type, __VA_ARGS__))
+#define JSON_FIELDS_15(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_14(Type, __VA_ARGS__))
+#define JSON_FIELDS_16(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_15(Type, __VA_ARGS__))
+#define JSON_FIELDS_17(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_16(Type, __VA_ARGS__))
+#define JSON_FIELDS_18(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_17(Type, __VA_ARGS__))
+#define JSON_FIELDS_19(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_18(Type, __VA_ARGS__))
+#define JSON_FIELDS_20(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_19(Type, __VA_ARGS__))
+#define JSON_FIELDS_21(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_20(Type, __VA_ARGS__))
+#define JSON_FIELDS_22(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_21(Type, __VA_ARGS__))
+#define JSON_FIELDS_23(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_22(Type, __VA_ARGS__))
+#define JSON_FIELDS_24(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_23(Type, __VA_ARGS__))
+#define JSON_FIELDS_25(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_24(Type, __VA_ARGS__))
+#define JSON_FIELDS_26(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_25(Type, __VA_ARGS__))
+#define JSON_FIELDS_27(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_26(Type, __VA_ARGS__))
+#define JSON_FIELDS_28(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_27(Type, __VA_ARGS__))
+#define JSON_FIELDS_29(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_28(Type, __VA_ARGS__))
+#define JSON_FIELDS_30(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_29(Type, __VA_ARGS__))
+#define JSON_FIELDS_31(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_30(Type, __VA_ARGS__))
+#define JSON_FIELDS_32(Type, f, ...) JSON_FIELDS_1(Type, f), JSON_FIELDS_EXPAND(JSON_FIELDS_31(Type, __VA_ARGS__))
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A member of a bound struct
+     */
+    template<class Class, class Member>
+    struct JsonField
+    {
+        string_view name;
+        Member Class::* member;
+    };
+
+    template<class Class, class Member>
+    constexpr JsonField<Class, Member> jsonField(string_view name, Member Class::* member) {
+        return { name, member };
+    }
+
+    /**
+     * True if JSON_FIELDS has been written for <T>
+     */
+    template<class T, class = void>
+    struct HasJsonFields : false_type { };
+    template<class T>
+    struct HasJsonFields<T, void_t<decltype(jsonFieldsOf((const T*)nullptr))>> : true_type { };
+
+    /**
+     * How a value is read from a JsonCursor and written to a JsonWriter
+     *
+     * Bools, numbers, strings, Json, vectors, optionals, maps of strings
+     * and the structs of JSON_FIELDS are bound, other types can have
+     * their own specialization. Nothing goes through a Json tree: the
+     * code of each type is generated by the templates. Strings keep
+     * their escapes, like the strings of a Json
+     *
+     * The members of a struct are read in any order, the missing ones
+     * keep their value and the unknown ones are skipped
+     */
+    template<class T, class Enable = void>
+    struct JsonBinding
+    {
+        static_assert(HasJsonFields<T>::value, "JSON_FIELDS(Type, members...) is missing for the type");
+
+        static bool read(JsonCursor& cursor, T& value) {
+            if (!cursor.startObject())
+                return false;
+
+            const auto fields = jsonFieldsOf((const T*)nullptr);
+            string_view key;
+
+            while (cursor.nextKey(key)) {
+                bool found = false;
+
+                auto readField = [&](const auto& field) {
+                    if (found || key != field.name)
+                        return;
+                    found = true;
+                    auto& member = value.*field.member;
+                    JsonBinding<decay_t<decltype(member)>>::read(cursor, member);
+                };
+                apply([&](const auto&... field) { (readField(field), ...); }, fields);
+
+                if (!found)
+                    cursor.skip();
+            }
+            return !cursor.failed();
+        }
+
+        static void write(JsonWriter& writer, const T& value) {
+            writer.startObject();
+            apply([&](const auto&... field) {
+                ((writer.key(field.name), JsonBinding<decay_t<decltype(value.*field.member)>>::write(writer, value.*field.member)), ...);
+            }, jsonFieldsOf((const T*)nullptr));
+            writer.endObject();
+        }
+    };
+
+    template<>
+    struct JsonBinding<bool>
+    {
+        static bool read(JsonCursor& cursor, bool& value) { return cursor.readBool(value); }
+        static void write(JsonWriter& writer, const bool& value) { writer.writeBool(value); }
+    };
+
+    /**
+     * Ints are read as long long and unsigned ints as unsigned
+     * long long, a value out of the range of the member fails the reading
+     */
+    template<class T>
+    struct JsonBinding<T, enable_if_t<is_integral_v<T> && !is_same_v<T, bool>>>
+    {
+        using Wide = conditional_t<is_signed_v<T>, long long, unsigned long long>;
+
+        static bool read(JsonCursor& cursor, T& value) {
+            Wide number;
+            if constexpr (is_signed_v<T>) {
+                if (!cursor.readInt(number))
+                    return false;
+            }
+            else if (!cursor.readUnsigned(number))
+                return false;
+
+            if (number < (Wide)numeric_limits<T>::min() || number > (Wide)numeric_limits<T>::max())
+                return cursor.fail('0', "An int in the range of the member");
+
+            value = (T)number;
+            return true;
+        }
+
+        static void write(JsonWriter& writer, const T& value) {
+            if constexpr (is_signed_v<T>)
+                writer.writeInt(value);
+            else
+                writer.writeUnsigned(value);
+        }
+    };
+
+    template<class T>
+    struct JsonBinding<T, enable_if_t<is_floating_point_v<T>>>
+    {
+        static bool read(JsonCursor& cursor, T& value) {
+            double number;
+            if (!cursor.readFloat(number))
+                return false;
+            value = (T)number;
+            return true;
+        }
+
+        static void write(JsonWriter& writer, const T& value) { writer.writeFloat((double)value); }
+    };
+
+    template<>
+    struct JsonBinding<string>
+    {
+        static bool read(JsonCursor& cursor, string& value) {
+            string_view text;
+            if (!cursor.readString(text))
+                return false;
+            value.assign(text);
+            return true;
+        }
+
+        static void write(JsonWriter& writer, const string& value) { writer.writeString(value); }
+    };
+
+    /**
+     * A part of the document that has no struct
+     */
+    template<>
+    struct JsonBinding<Json>
+    {
+        static bool read(JsonCursor& cursor, Json& value) { return cursor.readJson(value); }
+
+        static void write(JsonWriter& writer, const Json& value) { writer.write(value); }
+    };
+
+    template<class T>
+    struct JsonBinding<optional<T>>
+    {
+        static bool read(JsonCursor& cursor, optional<T>& value) {
+            if (cursor.readNull() || cursor.readUndefined()) {
+                value.reset();
+                return true;
+            }
+            return JsonBinding<T>::read(cursor, value.emplace());
+        }
+
+        static void write(JsonWriter& writer, const optional<T>& value) {
+            if (value)
+                JsonBinding<T>::write(writer, *value);
+            else
+                writer.writeNull();
+        }
+    };
+
+    template<class T, class Allocator>
+    struct JsonBinding<vector<T, Allocator>>
+    {
+        static bool read(JsonCursor& cursor, vector<T, Allocator>& value) {
+            if (!cursor.startArray())
+                return false;
+
+            value.clear();
+            while (cursor.nextElement()) {
+                T element{};
+                if (!JsonBinding<T>::read(cursor, element))
+                    return false;
+                value.push_back(std::move(element));
+            }
+            return !cursor.failed();
+        }
+
+        static void write(JsonWriter& writer, const vector<T, Allocator>& value) {
+            writer.startArray();
+            for (const auto& element : value)
+                JsonBinding<T>::write(writer, element);
+            writer.endArray();
+        }
+    };
+
+    /**
+     * Objects with any keys
+     */
+    template<class Map>
+    struct JsonMapBinding
+    {
+        static bool read(JsonCursor& cursor, Map& value) {
+            if (!cursor.startObject())
+                return false;
+
+            value.clear();
+            string_view key;
+            while (cursor.nextKey(key)) {
+                if (!JsonBinding<typename Map::mapped_type>::read(cursor, value[string(key)]))
+                    return false;
+            }
+            return !cursor.failed();
+        }
+
+        static void write(JsonWriter& writer, const Map& value) {
+            writer.startObject();
+            for (const auto& kv : value) {
+                writer.key(kv.first);
+                JsonBinding<typename Map::mapped_type>::write(writer, kv.second);
+            }
+            writer.endObject();
+        }
+    };
+
+    template<class T, class Compare, class Allocator>
+    struct JsonBinding<map<string, T, Compare, Allocator>> : JsonMapBinding<map<string, T, Compare, Allocator>> { };
+
+    template<class T, class Hash, class Equal, class Allocator>
+    struct JsonBinding<unordered_map<string, T, Hash, Equal, Allocator>> : JsonMapBinding<unordered_map<string, T, Hash, Equal, Allocator>> { };
+
+    /**
+     * Reading and writing of the bound types
+     */
+    class JsonStruct {
+
+        public: /**************** public members ****************/
+
+        /**
+         * Reads the <text> into <value>, returns false (with the
+         * diagnostics) if it doesn't have the shape of the type
+         * or if anything but whitespace follows the value
+         */
+        template<class T>
+        static bool fromString(string_view text, T& value) {
+            vector<string> diagnostics;
+            return fromString(text, value, diagnostics);
+        }
+
+        template<class T>
+        static bool fromString(string_view text, T& value, vector<string>& diagnostics) {
+            JsonCursor cursor(text);
+            bool read = JsonBinding<T>::read(cursor, value) && !cursor.failed() &&
+                (cursor.isAtEnd() || cursor.fail(' ', "Nothing after the value"));
+
+            auto& reported = cursor.Diagnostics();
+            diagnostics.insert(diagnostics.end(), reported.begin(), reported.end());
+            return read;
+        }
+
+        template<class T>
+        static bool read(JsonCursor& cursor, T& value) { return JsonBinding<T>::read(cursor, value); }
+
+        template<class T>
+        static void write(JsonWriter& writer, const T& value) { JsonBinding<T>::write(writer, value); }
+
+        template<class T>
+        static string toString(const T& value) {
+            string text;
+            {
+                JsonWriter writer(text);
+                write(writer, value);
+            }
+            return text;
+        }
+    };
+
+} // namespace JsonSer
+
+#endif
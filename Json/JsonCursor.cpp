@@ -0,0 +1,295 @@
+#include "JsonCursor.h"
+#include "JsonScanner.h"
+
+namespace JsonSer
+{
+
+    /************************** Json Cursor **************************/
+
+    void JsonCursor::ignoreWhiteSpace() {
+        while (_position < _text.size() && JsonScanner::isWhiteSpace(_text[_position]))
+            _position++;
+    }
+
+    /**
+     * Reads the number at the current position, an invalid
+     * one is reported where the scanner stopped
+     */
+    bool JsonCursor::readNumber(JsonScanner::Number& number) {
+        ignoreWhiteSpace();
+        const char c = current();
+        if (c != '-' && !JsonScanner::isDigit(c))
+            return fail('0', "A number");
+
+        number = JsonScanner::scanNumber(_text, _position);
+        if (number.type == JsonScanner::Number::Type::Invalid) {
+            _position = number.errorPosition;
+            return fail('0', number.additional);
+        }
+        return true;
+    }
+
+    bool JsonCursor::fail(const char& expected, const string& additional) {
+        if (!_failed)
+            _reporter.ReportUnexpectedChar(current(), _position, expected, additional);
+        _failed = true;
+        return false;
+    }
+
+    bool JsonCursor::readBool(bool& value) {
+        if (_failed)
+            return false;
+
+        ignoreWhiteSpace();
+        if (_text.substr(_position, 4) == "true") {
+            value = true;
+            _position += 4;
+            return true;
+        }
+        if (_text.substr(_position, 5) == "false") {
+            value = false;
+            _position += 5;
+            return true;
+        }
+        return fail('t', "A bool");
+    }
+
+    /**
+     * A number with a fraction or an exponent isn't an int
+     */
+    bool JsonCursor::readInt(long long& value) {
+        JsonScanner::Number number;
+        if (_failed || !readNumber(number))
+            return false;
+
+        if (number.type != JsonScanner::Number::Type::Int)
+            return fail('0', "An int");
+
+        _position = number.end;
+        value = number.integer;
+        return true;
+    }
+
+    /**
+     * An unsigned int too big for a long long is scanned
+     * as a float, its digits are read again
+     */
+    bool JsonCursor::readUnsigned(unsigned long long& value) {
+        JsonScanner::Number number;
+        if (_failed || !readNumber(number))
+            return false;
+
+        if (number.type == JsonScanner::Number::Type::Int) {
+            if (number.integer < 0)
+                return fail('0', "An unsigned int");
+            value = (unsigned long long)number.integer;
+        }
+        else {
+            const char* last = _text.data() + number.end;
+            auto result = from_chars(_text.data() + _position, last, value);
+            if (result.ec != errc() || result.ptr != last)
+                return fail('0', "An unsigned int");
+        }
+
+        _position = number.end;
+        return true;
+    }
+
+    bool JsonCursor::readFloat(double& value) {
+        JsonScanner::Number number;
+        if (_failed || !readNumber(number))
+            return false;
+
+        _position = number.end;
+        value = number.toDouble();
+        return true;
+    }
+
+    bool JsonCursor::readString(string_view& value) {
+        if (_failed)
+            return false;
+
+        ignoreWhiteSpace();
+        if (current() != '"')
+            return fail('"', "A string");
+
+        size_t start = _position + 1;
+        size_t end = JsonScanner::endOfString(_text, start);
+        if (end == string_view::npos) {
+            _position = _text.size();
+            return fail('"', "End of a string");
+        }
+
+        _position = end;
+        value = _text.substr(start, end - 1 - start);
+        return true;
+    }
+
+    bool JsonCursor::readNull() {
+        if (_failed)
+            return false;
+
+        ignoreWhiteSpace();
+        if (_text.substr(_position, 4) != "null")
+            return false;
+
+        _position += 4;
+        return true;
+    }
+
+    bool JsonCursor::readUndefined() {
+        if (_failed)
+            return false;
+
+        ignoreWhiteSpace();
+        if (_text.substr(_position, 9) != "undefined")
+            return false;
+
+        _position += 9;
+        return true;
+    }
+
+    bool JsonCursor::startObject() {
+        if (_failed)
+            return false;
+
+        ignoreWhiteSpace();
+        if (current() != '{')
+            return fail('{', "An object");
+
+        _position++;
+        _first = true;
+        return true;
+    }
+
+    bool JsonCursor::startArray() {
+        if (_failed)
+            return false;
+
+        ignoreWhiteSpace();
+        if (current() != '[')
+            return fail('[', "An array");
+
+        _position++;
+        _first = true;
+        return true;
+    }
+
+    bool JsonCursor::nextItem(const char& end) {
+        if (_failed)
+            return false;
+
+        ignoreWhiteSpace();
+        if (current() == end) {
+            _position++;
+            _first = false;
+            return false;
+        }
+
+        if (!_first) {
+            if (current() != ',')
+                return fail(end, end == '}' ? "End of an object" : "End of an array");
+            _position++;
+        }
+
+        _first = false;
+        return true;
+    }
+
+    bool JsonCursor::nextKey(string_view& key) {
+        if (!nextItem('}') || !readString(key))
+            return false;
+
+        ignoreWhiteSpace();
+        if (current() != ':')
+            return fail(':', "[key, value] of an object");
+
+        _position++;
+        return true;
+    }
+
+    bool JsonCursor::nextElement() {
+        return nextItem(']');
+    }
+
+    /**
+     * Only brackets and quotes are looked at inside containers (as
+     * by the shallow parse of a JsonReader), the other values are read
+     */
+    string_view JsonCursor::skip() {
+        if (_failed)
+            return string_view();
+
+        ignoreWhiteSpace();
+        const size_t start = _position;
+        const char first = current();
+
+        if (first == '{' || first == '[') {
+            const size_t size = _text.size();
+            size_t depth = 0;
+
+            do {
+                const char c = _text[_position++];
+
+                if (c == '"') {
+                    _position = JsonScanner::endOfString(_text, _position);
+                    if (_position == string_view::npos)
+                        _position = size;
+                }
+                else if (c == '{' || c == '[')
+                    depth++;
+                else if (c == '}' || c == ']')
+                    depth--;
+            } while (depth > 0 && _position < size);
+
+            if (depth > 0)
+                fail(first == '{' ? '}' : ']', "End of a skipped container");
+        }
+        else if (first == '"') {
+            string_view value;
+            readString(value);
+        }
+        else if (first == '-' || JsonScanner::isDigit(first)) {
+            JsonScanner::Number number;
+            if (readNumber(number))
+                _position = number.end;
+        }
+        else {
+            bool boolean;
+            if (!readNull() && !readUndefined() && ((first != 't' && first != 'f') || !readBool(boolean)))
+                fail('@', "Any valid json value");
+        }
+
+        _first = false;
+        return _failed ? string_view() : _text.substr(start, _position - start);
+    }
+
+    /**
+     * The skipped text only has its brackets matched,
+     * the errors inside it are found by the parsing
+     */
+    bool JsonCursor::readJson(Json& value) {
+        if (_failed)
+            return false;
+
+        ignoreWhiteSpace();
+        const size_t start = _position;
+        string_view text = skip();
+        if (_failed)
+            return false;
+
+        vector<string> diagnostics;
+        value = Json::fromString(text, diagnostics);
+        if (diagnostics.empty())
+            return true;
+
+        _position = start;
+        return fail('@', "A valid json value, " + diagnostics.front() + " inside it");
+    }
+
+    bool JsonCursor::isAtEnd() {
+        ignoreWhiteSpace();
+        return _position >= _text.size();
+    }
+
+} // namespace JsonSer
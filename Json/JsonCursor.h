@@ -0,0 +1,118 @@
+#ifndef JSON_CURSOR_API
+#define JSON_CURSOR_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+#include "JsonScanner.h"
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A pull reader: the caller asks for the value it expects next
+     *
+     * Nothing is built, strings are views of the input (with their
+     * escapes, like the strings of a Json), strings and numbers are
+     * scanned as by the JsonReader. A value of another type than the
+     * expected one is reported and the cursor fails, every read after
+     * that returns false
+     *
+     *     cursor.startObject();
+     *     while (cursor.nextKey(key))
+     *         key == "id" ? cursor.readInt(id) : cursor.skip();
+     */
+    class JsonCursor {
+
+        string_view _text;
+        size_t _position = 0;
+
+        /**
+         * True when the next member or element is the first one
+         * of its container (there is no comma before it)
+         */
+        bool _first = false;
+        bool _failed = false;
+
+        Json::Reporter _reporter;
+
+        char current() const { return _position < _text.size() ? _text[_position] : '\0'; }
+
+        void ignoreWhiteSpace();
+
+        /**
+         * Moves past the next member or element of a
+         * container, returns false at its <end>
+         */
+        bool nextItem(const char& end);
+
+        /**
+         * Scans the number at the current position (the position stays
+         * before it), returns false (and fails) if it isn't valid
+         */
+        bool readNumber(JsonScanner::Number&);
+
+        public: /**************** public members ****************/
+
+        JsonCursor(string_view text) :_text(text) { }
+
+        /**
+         * Reads a value of the expected type, returns false
+         * (and fails) if the next value is of another type
+         */
+        bool readBool(bool&);
+        bool readInt(long long&);
+        bool readUnsigned(unsigned long long&);
+        bool readFloat(double&);
+        bool readString(string_view&);
+
+        /**
+         * Reads a null or an undefined, returns false without
+         * failing if the next value isn't one
+         */
+        bool readNull();
+        bool readUndefined();
+
+        /**
+         * Containers: start, then next until it returns false (the
+         * end of the container has been read or the cursor failed)
+         */
+        bool startObject();
+        bool nextKey(string_view& key);
+        bool startArray();
+        bool nextElement();
+
+        /**
+         * Skips the next value and returns its text
+         */
+        string_view skip();
+
+        /**
+         * Skips the next value and parses its text into a Json, an
+         * invalid value is reported at its start and the cursor fails
+         */
+        bool readJson(Json&);
+
+        /**
+         * Reports an unexpected value at the current position,
+         * <expected> and <additional> as in Json::Reporter
+         */
+        bool fail(const char& expected, const string& additional);
+
+        bool failed() const { return _failed; }
+
+        /**
+         * Returns true if only whitespace is left
+         */
+        bool isAtEnd();
+
+        size_t position() const { return _position; }
+
+        vector<string>& Diagnostics() { return _reporter.Diagnostics(); }
+    };
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,515 @@
+#include "JsonDocument.h"
+#include "JsonReader.h"
+
+#include <array>
+#include <cstring>
+
+namespace JsonSer
+{
+
+    /**
+     * Tape words layout
+     */
+    static const int TAG_SHIFT = 56;
+    static const uint64_t PAYLOAD_MASK = (uint64_t(1) << TAG_SHIFT) - 1;
+    static const uint64_t COUNT_SATURATED = 0xFFFFFF;
+
+    static inline char tagOf(const uint64_t& word) {
+        return (char)(word >> TAG_SHIFT);
+    }
+    static inline uint64_t payloadOf(const uint64_t& word) {
+        return word & PAYLOAD_MASK;
+    }
+
+
+    /************************** Arena **************************/
+
+    void JsonDocument::Arena::reserve(size_t size) {
+        _block.reset(new char[size]);
+        _capacity = size;
+        _used = 0;
+    }
+
+    void* JsonDocument::Arena::allocate(size_t size, size_t alignment) {
+        size_t start = (_used + alignment - 1) & ~(alignment - 1);
+        if (start + size > _capacity)
+            return nullptr;
+        _used = start + size;
+        return _block.get() + start;
+    }
+
+    void JsonDocument::Arena::release() {
+        _block.reset();
+        _capacity = 0;
+        _used = 0;
+    }
+
+
+    /************************** Tape Builder **************************/
+
+    /**
+     * Appends the events of a JsonReader to the tape of the document
+     */
+    class JsonDocument::TapeBuilder : public JsonHandler {
+
+        JsonDocument& _document;
+        size_t _stringsUsed = 0;
+
+        size_t _tapeCapacity = 0;
+        size_t _stringsCapacity = 0;
+
+        /**
+         * True if a value didn't fit in the tape or in the string area,
+         * nothing more is written then (the reader isn't stopped, its
+         * handler calls stay branch free)
+         */
+        bool _full = false;
+
+        /**
+         * Tape index of the open containers
+         */
+        vector<size_t> _open;
+
+        /**
+         * Returns false if <words> tape words and <bytes> string
+         * bytes don't fit, the builder is then full for good
+         */
+        bool fits(const size_t& words, const size_t& bytes = 0) {
+            if (_document._tapeLength + words <= _tapeCapacity && _stringsUsed + bytes <= _stringsCapacity)
+                return true;
+            _full = true;
+            _tapeCapacity = 0;
+            return false;
+        }
+
+        /**
+         * Tape writers
+         */
+        size_t append(const char& tag, const uint64_t& payload = 0) {
+            _document._tape[_document._tapeLength] = (uint64_t(uint8_t(tag)) << TAG_SHIFT) | payload;
+            return _document._tapeLength++;
+        }
+        void appendRaw(const uint64_t& word) {
+            _document._tape[_document._tapeLength++] = word;
+        }
+        void appendWord(const char& tag, const uint64_t& payload = 0) {
+            if (fits(1))
+                append(tag, payload);
+        }
+        void appendString(const string_view& value) {
+            /**
+             * Every empty string shares the one at offset 0
+             */
+            if (value.empty()) {
+                appendWord('s', 0);
+                return;
+            }
+            if (!fits(1, sizeof(uint32_t) + value.size()))
+                return;
+
+            uint32_t length = (uint32_t)value.size();
+            memcpy(_document._strings + _stringsUsed, &length, sizeof(length));
+            memcpy(_document._strings + _stringsUsed + sizeof(length), value.data(), value.size());
+            append('s', _stringsUsed);
+            _stringsUsed += sizeof(length) + value.size();
+        }
+        void appendWide(const char& tag, const uint64_t& word) {
+            if (!fits(2))
+                return;
+            append(tag);
+            appendRaw(word);
+        }
+        bool open(const char& tag) {
+            if (fits(1))
+                _open.push_back(append(tag));
+            return true;
+        }
+        bool close(const char& tag, const uint64_t& count) {
+            if (!fits(1))
+                return true;
+
+            size_t open = _open.back();
+            _open.pop_back();
+
+            size_t close = append(tag, open);
+            uint64_t saturated = count < COUNT_SATURATED ? count : COUNT_SATURATED;
+            _document._tape[open] |= (saturated << 32) | close;
+            return true;
+        }
+
+        public: /**************** public members ****************/
+
+        TapeBuilder(JsonDocument& document)
+            :_document(document) { }
+
+        /**
+         * Reserves the tape and the string area, the
+         * document is built again from the start
+         */
+        void reserve(const size_t& tapeCapacity, size_t stringsCapacity) {
+            /**
+             * Offset 0 is the empty string
+             */
+            stringsCapacity += sizeof(uint32_t);
+
+            _document._arena.release();
+            _document._arena.reserve(tapeCapacity * sizeof(uint64_t) + stringsCapacity);
+            _document._tape = (uint64_t*)_document._arena.allocate(tapeCapacity * sizeof(uint64_t), alignof(uint64_t));
+            _document._strings = (char*)_document._arena.allocate(stringsCapacity, 1);
+            _document._tapeLength = 0;
+
+            memset(_document._strings, 0, sizeof(uint32_t));
+            _stringsUsed = sizeof(uint32_t);
+
+            _tapeCapacity = tapeCapacity;
+            _stringsCapacity = stringsCapacity;
+            _full = false;
+            _open.clear();
+        }
+
+        bool onNull() { appendWord('n'); return true; }
+        bool onUndefined() { appendWord('u'); return true; }
+        bool onBool(bool value) { appendWord(value ? 't' : 'f'); return true; }
+        bool onString(string_view value) { appendString(value); return true; }
+        bool onKey(string_view key) { appendString(key); return true; }
+
+        bool onInt(long long value) {
+            if (value >= -(1LL << (TAG_SHIFT - 1)) && value < (1LL << (TAG_SHIFT - 1)))
+                appendWord('l', uint64_t(value) & PAYLOAD_MASK);
+            else
+                appendWide('L', uint64_t(value));
+            return true;
+        }
+
+        bool onFloat(double value) {
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            appendWide('d', bits);
+            return true;
+        }
+
+        bool onStartObject() { return open('{'); }
+        bool onEndObject(size_t count) { return close('}', count); }
+        bool onStartArray() { return open('['); }
+        bool onEndArray(size_t count) { return close(']', count); }
+
+        /**
+         * Returns true if the tape or the string area was
+         * too small, the document is then incomplete
+         */
+        bool isFull() const { return _full; }
+
+        size_t stringsLength() const { return _stringsUsed; }
+    };
+
+
+    /************************** Json Document **************************/
+
+    /**
+     * Tape words and string bytes needed by the values of the <text>,
+     * counted on its structural index: a string (or a key) takes a word
+     * plus its length prefix and its bytes, a container takes two words
+     * and a scalar at most two (a float or a big int)
+     */
+    static void measure(string_view text, const vector<uint32_t>& positions, size_t& words, size_t& bytes) {
+        /**
+         * Half words of the value indexed at each char
+         * (the two quotes of a string share its word)
+         */
+        static const array<uint8_t, 256> halfWords = [] {
+            array<uint8_t, 256> table;
+            table.fill(4);
+            for (const char& c : string_view("}]:,"))
+                table[(uint8_t)c] = 0;
+            table['"'] = 1;
+            return table;
+        }();
+
+        size_t halves = 0;
+        int64_t stringBytes = 0;
+        bool inString = false;
+
+        /**
+         * The bytes of a string are the distance between its quotes,
+         * counted without branches since the quotes alternate
+         */
+        for (const uint32_t& position : positions) {
+            const uint8_t c = (uint8_t)text[position];
+            halves += halfWords[c];
+
+            const bool quote = c == '"';
+            inString ^= quote;
+            stringBytes += !quote ? 0 : inString ? -(int64_t)position - 1 : (int64_t)position + sizeof(uint32_t);
+        }
+
+        /**
+         * An unterminated string goes to the end of the text,
+         * an empty or a blank text gives an undefined value
+         */
+        if (inString) {
+            halves++;
+            stringBytes += text.size() + sizeof(uint32_t);
+        }
+        words = halves / 2 + 1;
+        bytes = (size_t)stringBytes;
+    }
+
+    /**
+     * Default constructor - an empty document
+     */
+    JsonDocument::JsonDocument() { }
+
+    /**
+     * Getting a document from string
+     */
+    JsonDocument JsonDocument::fromString(string_view text) {
+        JsonDocument document;
+
+        TapeBuilder builder(document);
+        JsonReader<TapeBuilder> reader(text, builder);
+
+        auto parse = [&](JsonReader<TapeBuilder>& parser) {
+            if (parser.parse())
+                parser.expectEnd();
+            document._diagnostics = parser.Diagnostics();
+        };
+
+        if (reader.Index().isBuilt()) {
+            size_t words, bytes;
+            measure(text, reader.Index().Positions(), words, bytes);
+            builder.reserve(words, bytes);
+            parse(reader);
+        }
+
+        /**
+         * The recovery of a syntax error can add values that aren't in
+         * the index: the tape is then reserved for the worst case, every
+         * char of the input produces at most two tape words (an unfinished
+         * container gets an undefined value and its end word) and at most
+         * two bytes of the string area (the 4 bytes length prefix of a
+         * string is paid by its quotes and its first char)
+         */
+        if (!reader.Index().isBuilt() || builder.isFull()) {
+            builder.reserve(2 * text.size() + 2, 2 * text.size() + 4);
+            JsonReader<TapeBuilder> fallback(text, builder, false);
+            parse(fallback);
+        }
+
+        document._stringsLength = builder.stringsLength();
+        return document;
+    }
+
+    /**
+     * The top level value
+     */
+    JsonRef JsonDocument::root() const {
+        if (_tapeLength == 0)
+            return JsonRef();
+        return JsonRef(this, 0);
+    }
+
+
+    /************************** Json Ref **************************/
+
+    JsonRef::JsonRef(const JsonDocument* document, size_t index)
+        :_document(document), _index(index) { }
+
+    char JsonRef::tag() const {
+        if (!_document)
+            return '\0';
+        return tagOf(_document->_tape[_index]);
+    }
+
+    /**
+     * Index of the word after the value at <index>
+     */
+    static size_t skipValue(const uint64_t* tape, size_t index) {
+        switch (tagOf(tape[index])) {
+            case '{':
+            case '[':
+                return (payloadOf(tape[index]) & 0xFFFFFFFF) + 1;
+            case 'L':
+            case 'd':
+                return index + 2;
+            default:
+                return index + 1;
+        }
+    }
+
+    bool JsonRef::isNull() const { return tag() == 'n'; }
+    bool JsonRef::isUndefined() const { return tag() == 'u'; }
+    bool JsonRef::isInt() const { return tag() == 'l' || tag() == 'L'; }
+    bool JsonRef::isFloat() const { return tag() == 'd'; }
+    bool JsonRef::isBool() const { return tag() == 't' || tag() == 'f'; }
+    bool JsonRef::isString() const { return tag() == 's'; }
+    bool JsonRef::isObject() const { return tag() == '{'; }
+    bool JsonRef::isArray() const { return tag() == '['; }
+
+    long long JsonRef::asInt() const {
+        switch (tag()) {
+            case 'l': {
+                /**
+                 * Sign extension of the 56 bits payload
+                 */
+                int64_t value = int64_t(_document->_tape[_index] << (64 - TAG_SHIFT)) >> (64 - TAG_SHIFT);
+                return value;
+            }
+            case 'L': return (long long)_document->_tape[_index + 1];
+            default: return 0;
+        }
+    }
+
+    double JsonRef::asFloat() const {
+        if (tag() != 'd')
+            return 0;
+        double value;
+        memcpy(&value, &_document->_tape[_index + 1], sizeof(value));
+        return value;
+    }
+
+    bool JsonRef::asBool() const {
+        return tag() == 't';
+    }
+
+    string_view JsonRef::asString() const {
+        if (tag() != 's')
+            return string_view();
+        const char* entry = _document->_strings + payloadOf(_document->_tape[_index]);
+        uint32_t length;
+        memcpy(&length, entry, sizeof(length));
+        return string_view(entry + sizeof(length), length);
+    }
+
+    size_t JsonRef::size() const {
+        char t = tag();
+        if (t != '{' && t != '[')
+            return 0;
+
+        const uint64_t* tape = _document->_tape;
+        uint64_t count = payloadOf(tape[_index]) >> 32;
+        if (count < COUNT_SATURATED)
+            return count;
+
+        size_t size = 0;
+        size_t i = _index + 1;
+        while (tagOf(tape[i]) != (t == '{' ? '}' : ']')) {
+            if (t == '{') i++;
+            i = skipValue(tape, i);
+            size++;
+        }
+        return size;
+    }
+
+    /**
+     * Accessing operators
+     */
+    JsonRef JsonRef::operator[](size_t n) const {
+        if (tag() != '[')
+            return JsonRef();
+
+        const uint64_t* tape = _document->_tape;
+        size_t i = _index + 1;
+        while (tagOf(tape[i]) != ']') {
+            if (n-- == 0)
+                return JsonRef(_document, i);
+            i = skipValue(tape, i);
+        }
+        return JsonRef();
+    }
+
+    JsonRef JsonRef::operator[](string_view key) const {
+        if (tag() != '{')
+            return JsonRef();
+
+        const uint64_t* tape = _document->_tape;
+        size_t i = _index + 1;
+        while (tagOf(tape[i]) != '}') {
+            if (JsonRef(_document, i).asString() == key)
+                return JsonRef(_document, i + 1);
+            i = skipValue(tape, i + 1);
+        }
+        return JsonRef();
+    }
+
+    /**
+     * Copies the value into a Json tree
+     */
+    Json JsonRef::toJson() const {
+        switch (tag()) {
+            case 'n': return Json(nullptr);
+            case 'l':
+            case 'L': return Json(asInt());
+            case 'd': return Json(asFloat());
+            case 't':
+            case 'f': return Json(asBool());
+            case 's': return Json(string(asString()));
+            case '{': {
+                Json::Object value;
+                value.reserve(size());
+                const uint64_t* tape = _document->_tape;
+                size_t i = _index + 1;
+                while (tagOf(tape[i]) != '}') {
+                    value.try_emplace(JsonRef(_document, i).asString(), JsonRef(_document, i + 1).toJson());
+                    i = skipValue(tape, i + 1);
+                }
+                return Json(std::move(value));
+            }
+            case '[': {
+                Json::Array value(Json::heap());
+                value.reserve(size());
+                const uint64_t* tape = _document->_tape;
+                size_t i = _index + 1;
+                while (tagOf(tape[i]) != ']') {
+                    value.emplace_back(JsonRef(_document, i).toJson());
+                    i = skipValue(tape, i);
+                }
+                return Json(std::move(value));
+            }
+            default: return Json();
+        }
+    }
+
+    /**
+     * Getting a string from the value
+     */
+    string JsonRef::toString() const {
+        string out;
+        JsonWriter writer(out);
+        write(writer);
+        return out;
+    }
+
+    void JsonRef::write(JsonWriter& writer) const {
+        switch (tag()) {
+            case 'n': return writer.writeNull();
+            case 'l':
+            case 'L': return writer.writeInt(asInt());
+            case 'd': return writer.writeFloat(asFloat());
+            case 't':
+            case 'f': return writer.writeBool(asBool());
+            case 's': return writer.writeString(asString());
+            case '{':
+            case '[': {
+                bool object = tag() == '{';
+                const uint64_t* tape = _document->_tape;
+                size_t i = _index + 1;
+
+                if (object) writer.startObject();
+                else writer.startArray();
+
+                while (tagOf(tape[i]) != (object ? '}' : ']')) {
+                    if (object)
+                        writer.key(JsonRef(_document, i++).asString());
+                    JsonRef(_document, i).write(writer);
+                    i = skipValue(tape, i);
+                }
+
+                if (object) writer.endObject();
+                else writer.endArray();
+                return;
+            }
+            default: return writer.writeUndefined();
+        }
+    }
+
+} // namespace JsonSer
@@ -0,0 +1,180 @@
+#ifndef JSON_DOCUMENT_API
+#define JSON_DOCUMENT_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+#include "JsonWriter.h"
+
+#include <cstdint>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    class JsonDocument;
+
+    /**
+     * A lightweight handle to a value stored inside a JsonDocument,
+     * it doesn't own anything and it's valid as long as the document is
+     */
+    class JsonRef {
+
+        const JsonDocument* _document = nullptr;
+        size_t _index = 0;
+
+        /**
+         * Tag of the tape word the handle points to
+         */
+        char tag() const;
+
+        public: /**************** public members ****************/
+
+        /**
+         * Default constructor - an invalid handle
+         */
+        JsonRef() { }
+        JsonRef(const JsonDocument*, size_t);
+
+        /**
+         * Returns false for a missing value
+         */
+        bool isValid() const { return _document != nullptr; }
+
+        bool isNull() const;
+        bool isUndefined() const;
+        bool isInt() const;
+        bool isFloat() const;
+        bool isBool() const;
+        bool isString() const;
+        bool isObject() const;
+        bool isArray() const;
+
+        /**
+         * Value getters, a default value is returned
+         * when the type doesn't match
+         */
+        long long asInt() const;
+        double asFloat() const;
+        bool asBool() const;
+        string_view asString() const;
+
+        /**
+         * Number of elements of an array or members of an object
+         */
+        size_t size() const;
+
+        /**
+         * Accessing operators, an invalid handle is
+         * returned for a missing element
+         */
+        JsonRef operator[](size_t i) const;
+        JsonRef operator[](string_view key) const;
+
+        /**
+         * Copies the value into a Json tree
+         */
+        Json toJson() const;
+
+        /**
+         * Getting a string from the value
+         */
+        string toString() const;
+        void write(JsonWriter&) const;
+    };
+
+    /**
+     * A parsed json stored as a flat tape inside a single arena
+     *
+     * Every value is one 64 bit word (<tag:8><payload:56>):
+     * containers store the index of their matching end word (and the
+     * number of elements), strings store an offset into the string
+     * area, ints that don't fit in 56 bits and floats use one more word
+     */
+    class JsonDocument {
+
+        friend class JsonRef;
+
+        /**
+         * A monotonic arena, all the memory is
+         * reserved at once and released at once
+         */
+        class Arena {
+
+            unique_ptr<char[]> _block;
+            size_t _capacity = 0;
+            size_t _used = 0;
+
+            public: /**************** public members ****************/
+
+            /**
+             * Reserves a block of <size> bytes
+             */
+            void reserve(size_t);
+
+            /**
+             * Bump allocation inside the block
+             */
+            void* allocate(size_t, size_t);
+
+            /**
+             * Releases the whole block
+             */
+            void release();
+
+            size_t capacity() const { return _capacity; }
+        };
+
+        /**
+         * Builds the tape
+         */
+        class TapeBuilder;
+
+        Arena _arena;
+
+        uint64_t* _tape = nullptr;
+        size_t _tapeLength = 0;
+
+        char* _strings = nullptr;
+        size_t _stringsLength = 0;
+
+        vector<string> _diagnostics;
+
+        public: /**************** public members ****************/
+
+        /**
+         * Default constructor - an empty document
+         */
+        JsonDocument();
+
+        JsonDocument(JsonDocument&&) = default;
+        JsonDocument& operator=(JsonDocument&&) = default;
+
+        JsonDocument(const JsonDocument&) = delete;
+        JsonDocument& operator=(const JsonDocument&) = delete;
+
+        /**
+         * Getting a document from string
+         */
+        static JsonDocument fromString(string_view);
+
+        /**
+         * The top level value
+         */
+        JsonRef root() const;
+
+        /**
+         * Bytes reserved by the document
+         */
+        size_t capacity() const { return _arena.capacity(); }
+
+        /**
+         * Returns any diagnostic
+         */
+        vector<string>& Diagnostics() { return _diagnostics; }
+    };
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef JSON_KEY_SET_API
+#define JSON_KEY_SET_API
+
+/**
+ * Libraries
+ */
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A set of keys known at compile time and a perfect hash of them:
+     * each key is found at a fixed slot (its position in the list)
+     * with one hash of the key and one comparison
+     *
+     *     constexpr auto keys = makeKeySet("host", "port", "timeout");
+     *     constexpr size_t PORT = keys.find("port");   // 1
+     *     keys.find(key);                               // NOT_FOUND if unknown
+     *
+     * The hash is built by hash and displace: the keys are spread over
+     * N buckets and each bucket gets the displacement that sends its keys
+     * to free positions of a table of twice as many entries. Duplicated
+     * keys don't compile
+     *
+     * Only the length and the first, middle and last chars of a key are
+     * hashed (no loop) unless two keys of the set share them, then their
+     * first and last SAMPLED / 2 chars are, or else the whole keys
+     */
+    template<size_t N>
+    class JsonKeySet {
+
+        static_assert(N > 0 && N < 0xFFFF, "A key set has from 1 to 65534 keys");
+
+        static constexpr size_t tableSize() {
+            size_t size = 2;
+            while (size < 2 * N) size *= 2;
+            return size;
+        }
+
+        static constexpr size_t TABLE = tableSize();
+
+        /**
+         * What is hashed from a key: its length and first, middle
+         * and last chars, its first and last SAMPLED / 2 chars
+         * (up to SAMPLED chars) or all of it
+         */
+        enum class Hashed : uint8_t { Edges, Sampled, Whole };
+
+        static constexpr size_t SAMPLED = 16;
+
+        array<string_view, N> _keys{};
+
+        /**
+         * Slots + 1 by position (0 is an empty position)
+         * and displacements by bucket
+         */
+        array<uint16_t, TABLE> _table{};
+        array<uint32_t, N> _displacements{};
+
+        Hashed _hashed = Hashed::Edges;
+
+        static constexpr uint64_t hash(string_view key, Hashed hashed) {
+            size_t size = key.size();
+
+            if (hashed == Hashed::Edges) {
+                uint64_t edges = size == 0 ? 0 : (uint64_t)(uint8_t)key[0] << 32 |
+                    (uint64_t)(uint8_t)key[size / 2] << 40 | (uint64_t)(uint8_t)key[size - 1] << 48;
+                uint64_t h = (edges | (uint32_t)size) * 0x9E3779B97F4A7C15ull;
+                return h ^ (h >> 29);
+            }
+
+            uint64_t h = 0xCBF29CE484222325ull ^ size;
+            if (hashed == Hashed::Whole || size <= SAMPLED) {
+                for (size_t i = 0; i < size; i++)
+                    h = (h ^ (uint8_t)key[i]) * 0x100000001B3ull;
+            }
+            else {
+                for (size_t i = 0; i < SAMPLED / 2; i++)
+                    h = (h ^ (uint8_t)key[i]) * 0x100000001B3ull;
+                for (size_t i = size - SAMPLED / 2; i < size; i++)
+                    h = (h ^ (uint8_t)key[i]) * 0x100000001B3ull;
+            }
+            return h;
+        }
+
+        /**
+         * Position of a key of hash <h> in a bucket of <displacement>
+         */
+        static constexpr size_t position(uint64_t h, uint32_t displacement) {
+            h ^= displacement * 0x9E3779B97F4A7C15ull;
+            h ^= h >> 33;
+            h *= 0xFF51AFD7ED558CCDull;
+            h ^= h >> 33;
+            return (size_t)(h & (TABLE - 1));
+        }
+
+        /**
+         * Returns true if two keys have the same hash
+         */
+        constexpr bool collides(Hashed hashed) const {
+            for (size_t i = 0; i < N; i++)
+                for (size_t j = i + 1; j < N; j++)
+                    if (hash(_keys[i], hashed) == hash(_keys[j], hashed))
+                        return true;
+            return false;
+        }
+
+        /**
+         * Places the keys of the <bucket> with the first
+         * displacement that fits them, returns false if none does
+         */
+        constexpr bool place(size_t bucket) {
+            for (uint32_t displacement = 0; displacement < (1u << 20); displacement++) {
+                array<size_t, N> positions{};
+                size_t count = 0;
+                bool fits = true;
+
+                for (size_t slot = 0; slot < N && fits; slot++) {
+                    uint64_t h = hash(_keys[slot], _hashed);
+                    if (h % N != bucket)
+                        continue;
+
+                    size_t at = position(h, displacement);
+                    fits = _table[at] == 0;
+                    for (size_t i = 0; i < count && fits; i++)
+                        fits = positions[i] != at;
+                    positions[count++] = at;
+                }
+
+                if (!fits)
+                    continue;
+
+                for (size_t slot = 0, i = 0; slot < N; slot++)
+                    if (hash(_keys[slot], _hashed) % N == bucket)
+                        _table[positions[i++]] = (uint16_t)(slot + 1);
+
+                _displacements[bucket] = displacement;
+                return true;
+            }
+            return false;
+        }
+
+        public: /**************** public members ****************/
+
+        static constexpr size_t NOT_FOUND = (size_t)-1;
+
+        constexpr JsonKeySet(const array<string_view, N>& keys) :_keys(keys) {
+            for (size_t i = 0; i < N; i++)
+                for (size_t j = i + 1; j < N; j++)
+                    if (_keys[i] == _keys[j])
+                        throw logic_error("A key set has a duplicated key");
+
+            if (collides(Hashed::Edges))
+                _hashed = collides(Hashed::Sampled) ? Hashed::Whole : Hashed::Sampled;
+            if (_hashed == Hashed::Whole && collides(Hashed::Whole))
+                throw logic_error("Two keys of the set have the same hash");
+
+            /**
+             * The biggest buckets are placed first, while the table is empty
+             */
+            array<size_t, N> sizes{};
+            size_t biggest = 0;
+            for (size_t slot = 0; slot < N; slot++) {
+                size_t size = ++sizes[hash(_keys[slot], _hashed) % N];
+                if (size > biggest) biggest = size;
+            }
+
+            for (size_t size = biggest; size > 0; size--)
+                for (size_t bucket = 0; bucket < N; bucket++)
+                    if (sizes[bucket] == size && !place(bucket))
+                        throw logic_error("No perfect hash found for the key set");
+        }
+
+        /**
+         * Slot of the <key>, NOT_FOUND if it isn't in the set
+         */
+        constexpr size_t find(string_view key) const {
+            uint64_t h = hash(key, _hashed);
+            size_t slot = (size_t)_table[position(h, _displacements[h % N])];
+            return slot && _keys[slot - 1] == key ? slot - 1 : NOT_FOUND;
+        }
+
+        constexpr bool contains(string_view key) const { return find(key) != NOT_FOUND; }
+
+        /**
+         * Key of a slot
+         */
+        constexpr string_view operator[](size_t slot) const { return _keys[slot]; }
+
+        static constexpr size_t size() { return N; }
+    };
+
+    /**
+     * The key set of the <keys>, in the order of their slots
+     */
+    template<class... Keys>
+    constexpr JsonKeySet<sizeof...(Keys)> makeKeySet(const Keys&... keys) {
+        return JsonKeySet<sizeof...(Keys)>(array<string_view, sizeof...(Keys)>{ string_view(keys)... });
+    }
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,276 @@
+#include "JsonPath.h"
+
+namespace JsonSer
+{
+
+    /************************** Json Path ********************************/
+
+    JsonPath::JsonPath(string_view expression) {
+        if (!expression.empty() && expression[0] == '$')
+            compilePath(expression);
+        else
+            compilePointer(expression);
+    }
+
+    void JsonPath::addMember(string key, bool pointerToken) {
+        Segment segment;
+        segment.kind = Segment::Kind::Member;
+        segment.hash = Json::Key::hashOf(key);
+
+        /**
+         * "0" or digits without a leading zero
+         */
+        if (pointerToken && !key.empty() && key.size() < 19 && (key[0] != '0' || key.size() == 1)) {
+            segment.isIndex = true;
+            for (const char& c : key) {
+                if (c < '0' || c > '9') {
+                    segment.isIndex = false;
+                    break;
+                }
+                segment.index = segment.index * 10 + (c - '0');
+            }
+            if (!segment.isIndex)
+                segment.index = 0;
+        }
+
+        segment.key = std::move(key);
+        _segments.push_back(std::move(segment));
+    }
+
+    void JsonPath::addIndex(long long index) {
+        Segment segment;
+        segment.kind = Segment::Kind::Index;
+        segment.index = index;
+        segment.isIndex = true;
+        _segments.push_back(std::move(segment));
+    }
+
+    void JsonPath::addWildcard() {
+        Segment segment;
+        segment.kind = Segment::Kind::Wildcard;
+        _segments.push_back(std::move(segment));
+    }
+
+    /**
+     * JSON Pointer: "" or a sequence of "/" + token,
+     * "~0" stands for '~' and "~1" for '/'
+     */
+    void JsonPath::compilePointer(const string_view& expression) {
+        if (expression.empty())
+            return;
+
+        if (expression[0] != '/') {
+            _reporter.ReportUnexpectedChar(expression[0], 0, '/', "Start of a JSON Pointer");
+            _valid = false;
+            return;
+        }
+
+        size_t position = 1;
+        while (true) {
+            string token;
+
+            for (; position < expression.size() && expression[position] != '/'; position++) {
+                const char& c = expression[position];
+
+                if (c != '~') {
+                    token.push_back(c);
+                    continue;
+                }
+
+                char next = position + 1 < expression.size() ? expression[position + 1] : '\0';
+                if (next != '0' && next != '1') {
+                    _reporter.ReportUnexpectedChar(next, position + 1, '0', "Escape of a JSON Pointer");
+                    _valid = false;
+                    return;
+                }
+                token.push_back(next == '0' ? '~' : '/');
+                position++;
+            }
+
+            addMember(std::move(token), true);
+
+            if (position >= expression.size())
+                return;
+            position++;
+        }
+    }
+
+    /**
+     * JSONPath subset: "$" followed by ".name", ".*",
+     * "['name']", "[\"name\"]", "[index]" and "[*]"
+     */
+    void JsonPath::compilePath(const string_view& expression) {
+        size_t position = 1;
+
+        auto fail = [&](const char& expected, const string& additional) {
+            char current = position < expression.size() ? expression[position] : '\0';
+            _reporter.ReportUnexpectedChar(current, position, expected, additional);
+            _valid = false;
+        };
+
+        while (position < expression.size()) {
+            const char& c = expression[position];
+
+            if (c == '.') {
+                position++;
+
+                if (position < expression.size() && expression[position] == '*') {
+                    position++;
+                    addWildcard();
+                    continue;
+                }
+
+                size_t start = position;
+                while (position < expression.size() && expression[position] != '.' && expression[position] != '[')
+                    position++;
+
+                if (position == start)
+                    return fail('*', "Name of a member");
+
+                addMember(string(expression.substr(start, position - start)), false);
+            }
+            else if (c == '[') {
+                position++;
+
+                if (position >= expression.size())
+                    return fail(']', "Subscript");
+
+                const char& first = expression[position];
+
+                if (first == '*') {
+                    position++;
+                    addWildcard();
+                }
+                else if (first == '\'' || first == '"') {
+                    string key;
+                    position++;
+
+                    while (position < expression.size() && expression[position] != first) {
+                        if (expression[position] == '\\' && position + 1 < expression.size())
+                            position++;
+                        key.push_back(expression[position++]);
+                    }
+
+                    if (position >= expression.size())
+                        return fail(first, "End of a quoted name");
+
+                    position++;
+                    addMember(std::move(key), false);
+                }
+                else {
+                    bool negative = first == '-';
+                    if (negative)
+                        position++;
+
+                    size_t start = position;
+                    long long index = 0;
+                    while (position < expression.size() && expression[position] >= '0' && expression[position] <= '9')
+                        index = index * 10 + (expression[position++] - '0');
+
+                    if (position == start || position - start > 18)
+                        return fail('0', "Array index");
+
+                    addIndex(negative ? -index : index);
+                }
+
+                if (position >= expression.size() || expression[position] != ']')
+                    return fail(']', "End of a subscript");
+                position++;
+            }
+            else
+                return fail('.', "Segment of a path");
+        }
+    }
+
+    /**
+     * Child of a json by a segment or nullptr
+     */
+    Json* JsonPath::child(Json& json, const Segment& segment) {
+        if (json._type == Json::JsonType::Object) {
+            if (segment.kind != Segment::Kind::Member)
+                return nullptr;
+
+            auto& object = json.container()->_object;
+            auto found = object.find(segment.key, segment.hash);
+            return found == object.end() ? nullptr : &found->second;
+        }
+
+        if (json._type == Json::JsonType::Array && segment.isIndex) {
+            auto& array = json.container()->_array;
+            long long index = segment.index < 0 ? (long long)array.size() + segment.index : segment.index;
+
+            if (index < 0 || index >= (long long)array.size())
+                return nullptr;
+            return &array[index];
+        }
+
+        return nullptr;
+    }
+
+    template<class Visit>
+    bool JsonPath::walk(Json& json, size_t segment, Visit& visit) const {
+        Json* current = &json;
+
+        /**
+         * Single children are followed without recursion
+         */
+        for (; segment < _segments.size(); segment++) {
+            const Segment& step = _segments[segment];
+
+            if (step.kind == Segment::Kind::Wildcard)
+                break;
+
+            current = child(*current, step);
+            if (!current)
+                return true;
+        }
+
+        if (segment == _segments.size())
+            return visit(*current);
+
+        if (current->_type == Json::JsonType::Object) {
+            for (auto& kv : current->container()->_object)
+                if (!walk(kv.second, segment + 1, visit)) return false;
+        }
+        else if (current->_type == Json::JsonType::Array) {
+            for (auto& e : current->container()->_array)
+                if (!walk(e, segment + 1, visit)) return false;
+        }
+        return true;
+    }
+
+    Json* JsonPath::find(Json& json) const {
+        Json* found = nullptr;
+
+        if (!_valid)
+            return found;
+
+        auto visit = [&](Json& match) {
+            found = &match;
+            return false;
+        };
+        walk(json, 0, visit);
+
+        return found;
+    }
+
+    const Json* JsonPath::find(const Json& json) const {
+        return find(const_cast<Json&>(json));
+    }
+
+    size_t JsonPath::findAll(Json& json, vector<Json*>& matches) const {
+        size_t count = matches.size();
+
+        if (!_valid)
+            return 0;
+
+        auto visit = [&](Json& match) {
+            matches.push_back(&match);
+            return true;
+        };
+        walk(json, 0, visit);
+
+        return matches.size() - count;
+    }
+
+} // namespace JsonSer
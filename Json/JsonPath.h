@@ -0,0 +1,118 @@
+#ifndef JSON_PATH_API
+#define JSON_PATH_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A precompiled path into a Json
+     *
+     * Two syntaxes are accepted:
+     * - JSON Pointer (RFC 6901): "", "/ranges/0", "/a~1b/m~0n"
+     * - a JSONPath subset: "$", "$.ranges[0]", "$['a.b']", "$.items[*].id",
+     *   "$.items[-1]" (from the end)
+     * The expression is parsed once, keys are hashed once, evaluating a
+     * path doesn't allocate and a miss is a null result (never an exception)
+     */
+    class JsonPath {
+
+        /**
+         * A step of the path
+         */
+        struct Segment
+        {
+            enum class Kind : uint8_t
+            {
+                Member,
+                Index,
+                Wildcard
+            };
+
+            Kind kind;
+
+            /**
+             * Member name and its hash
+             */
+            string key;
+            size_t hash = 0;
+
+            /**
+             * Array index, a pointer token made of digits is
+             * a member name for objects and an index for arrays
+             */
+            long long index = 0;
+            bool isIndex = false;
+        };
+
+        vector<Segment> _segments;
+
+        Json::Reporter _reporter;
+        bool _valid = true;
+
+        /**
+         * Compilers of each syntax
+         */
+        void compilePointer(const string_view&);
+        void compilePath(const string_view&);
+
+        void addMember(string key, bool pointerToken);
+        void addIndex(long long index);
+        void addWildcard();
+
+        /**
+         * Calls <visit> with every match of the segments from <segment>,
+         * stops when <visit> returns false
+         */
+        template<class Visit>
+        bool walk(Json& json, size_t segment, Visit& visit) const;
+
+        /**
+         * Child of a json by a segment or nullptr
+         */
+        static Json* child(Json& json, const Segment& segment);
+
+        public: /**************** public members ****************/
+
+        /**
+         * Compiles the <expression>, errors go to the diagnostics
+         */
+        JsonPath(string_view expression);
+
+        /**
+         * Returns false if the expression couldn't be compiled
+         * (such a path matches nothing)
+         */
+        bool isValid() const { return _valid; }
+
+        /**
+         * Number of segments
+         */
+        size_t size() const { return _segments.size(); }
+
+        /**
+         * The first value matched by the path, nullptr when there is none
+         */
+        Json* find(Json&) const;
+        const Json* find(const Json&) const;
+
+        /**
+         * Appends all the values matched by the path to <matches>,
+         * returns the number of values appended
+         */
+        size_t findAll(Json&, vector<Json*>& matches) const;
+
+        /**
+         * Diagnostic property
+         */
+        vector<string>& Diagnostics() { return _reporter.Diagnostics(); }
+    };
+
+} // namespace JsonSer
+
+#endif
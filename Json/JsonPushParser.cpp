@@ -0,0 +1,336 @@
+#include "JsonPushParser.h"
+
+namespace JsonSer
+{
+
+    /************************** Json Push Parser **************************/
+
+    /**
+     * Default constructor
+     */
+    JsonPushParser::JsonPushParser(const Json::ParseOptions& options) :_builder(options) { }
+
+    /**
+     * Chars that end a number or a literal
+     */
+    bool JsonPushParser::isDelimiter(const char& c) {
+        return JsonScanner::isWhiteSpace(c) || c == ',' || c == ':' || c == '"' ||
+            c == '{' || c == '}' || c == '[' || c == ']';
+    }
+
+    void JsonPushParser::startContainer(const bool& object) {
+        if (object) _builder.onStartObject();
+        else _builder.onStartArray();
+
+        _containers.push_back(Container{ object, 0 });
+        _expect = object ? Expect::FirstKey : Expect::FirstElement;
+    }
+
+    void JsonPushParser::endContainer(vector<Json>& values) {
+        Container container = _containers.back();
+        _containers.pop_back();
+
+        if (container.object) _builder.onEndObject(container.count);
+        else _builder.onEndArray(container.count);
+
+        completed(values);
+    }
+
+    void JsonPushParser::completed(vector<Json>& values) {
+        if (_containers.empty()) {
+            values.push_back(_builder.Take());
+            _expect = Expect::Value;
+            return;
+        }
+
+        _containers.back().count++;
+        _expect = Expect::Separator;
+    }
+
+    void JsonPushParser::fail(const char& current, const size_t& position, const char& expected, const string& additional,
+        vector<Json>& values)
+    {
+        _reporter.ReportUnexpectedChar(current, position, expected, additional);
+
+        if (_containers.empty()) {
+            _builder.onUndefined();
+            completed(values);
+            return;
+        }
+
+        _skipDepth = _containers.size();
+        while (!_containers.empty())
+            endContainer(values);
+    }
+
+    void JsonPushParser::unexpected(const char& current, const size_t& position, vector<Json>& values) {
+        switch (_expect) {
+            case Expect::Value:
+            case Expect::FirstElement:
+                return fail(current, position, '@', "Any valid json value", values);
+            case Expect::FirstKey:
+            case Expect::Key:
+                return fail(current, position, '"', "[KEY, value] of an object", values);
+            case Expect::Colon:
+                return fail(current, position, ':', "[key, value] of an object", values);
+            case Expect::Separator:
+                if (_containers.back().object)
+                    return fail(current, position, '}', "End of an object", values);
+                return fail(current, position, ']', "End of an array", values);
+        }
+    }
+
+    /**
+     * A string resumed from the previous chunk starts with an
+     * escaped char if that chunk ended with an odd number of backslashes
+     */
+    size_t JsonPushParser::readString(const string_view& chunk, size_t start, vector<Json>& values) {
+        size_t backslashes = 0;
+        while (backslashes < _pending.size() && _pending[_pending.size() - 1 - backslashes] == '\\')
+            backslashes++;
+
+        size_t end = JsonScanner::endOfString(chunk, min(start + backslashes % 2, chunk.size()));
+        if (end == string_view::npos) {
+            _pending.append(chunk.substr(start));
+            return chunk.size();
+        }
+
+        string_view text = chunk.substr(start, end - 1 - start);
+        if (!_pending.empty()) {
+            _pending.append(text);
+            text = _pending;
+        }
+
+        Token token = _token;
+        _token = Token::None;
+
+        if (token == Token::String) {
+            _builder.onString(text);
+            completed(values);
+        }
+        else if (token == Token::Key) {
+            _builder.onKey(text);
+            _expect = Expect::Colon;
+        }
+
+        _pending.clear();
+        return end;
+    }
+
+    size_t JsonPushParser::readScalar(const string_view& chunk, size_t start, vector<Json>& values) {
+        size_t end = start;
+        while (end < chunk.size() && !isDelimiter(chunk[end]))
+            end++;
+
+        if (end == chunk.size()) {
+            _pending.append(chunk.substr(start));
+            return end;
+        }
+
+        string_view text = chunk.substr(start, end - start);
+        if (!_pending.empty()) {
+            _pending.append(text);
+            text = _pending;
+        }
+
+        _token = Token::None;
+        completeScalar(text, chunk[end], values);
+        _pending.clear();
+        return end;
+    }
+
+    /**
+     * The chars after a number or a literal are read
+     * as the ones after any other value
+     */
+    void JsonPushParser::completeScalar(const string_view& text, const char& next, vector<Json>& values) {
+        const char first = text[0];
+        size_t length;
+
+        if (first == '-' || JsonScanner::isDigit(first)) {
+            JsonScanner::Number number = JsonScanner::scanNumber(text, 0);
+
+            if (number.type == JsonScanner::Number::Type::Invalid) {
+                size_t at = number.errorPosition;
+                return fail(at < text.size() ? text[at] : next, _tokenStart + at, '0', number.additional, values);
+            }
+
+            if (number.type == JsonScanner::Number::Type::Int) _builder.onInt(number.integer);
+            else _builder.onFloat(number.floating);
+            length = number.end;
+        }
+        else if (text.substr(0, 4) == "true" || text.substr(0, 5) == "false") {
+            _builder.onBool(first == 't');
+            length = first == 't' ? 4 : 5;
+        }
+        else if (text.substr(0, 4) == "null") {
+            _builder.onNull();
+            length = 4;
+        }
+        else if (text.substr(0, 9) == "undefined") {
+            _builder.onUndefined();
+            length = 9;
+        }
+        else
+            return unexpected(first, _tokenStart, values);
+
+        completed(values);
+
+        if (length < text.size())
+            unexpected(text[length], _tokenStart + length, values);
+    }
+
+    size_t JsonPushParser::step(const string_view& chunk, size_t i, vector<Json>& values) {
+        const char c = chunk[i];
+        if (JsonScanner::isWhiteSpace(c))
+            return i + 1;
+
+        const size_t position = _offset + i;
+
+        switch (_expect) {
+            case Expect::FirstElement:
+                if (c == ']') {
+                    endContainer(values);
+                    return i + 1;
+                }
+                [[fallthrough]];
+
+            case Expect::Value:
+                if (c == '{' || c == '[') {
+                    startContainer(c == '{');
+                    return i + 1;
+                }
+                if (c == '"') {
+                    _token = Token::String;
+                    _tokenStart = position;
+                    return readString(chunk, i + 1, values);
+                }
+                if (isDelimiter(c))
+                    break;
+
+                _token = Token::Scalar;
+                _tokenStart = position;
+                return readScalar(chunk, i, values);
+
+            case Expect::FirstKey:
+                if (c == '}') {
+                    endContainer(values);
+                    return i + 1;
+                }
+                [[fallthrough]];
+
+            case Expect::Key:
+                if (c != '"')
+                    break;
+
+                _token = Token::Key;
+                _tokenStart = position;
+                return readString(chunk, i + 1, values);
+
+            case Expect::Colon:
+                if (c != ':')
+                    break;
+
+                _expect = Expect::Value;
+                return i + 1;
+
+            case Expect::Separator:
+                if (c == ',') {
+                    _expect = _containers.back().object ? Expect::Key : Expect::Value;
+                    return i + 1;
+                }
+                if (c == (_containers.back().object ? '}' : ']')) {
+                    endContainer(values);
+                    return i + 1;
+                }
+                break;
+        }
+
+        unexpected(c, position, values);
+
+        /**
+         * Inside a container the char is read again as
+         * a part of the value being skipped
+         */
+        return _skipDepth > 0 ? i : i + 1;
+    }
+
+    /**
+     * Only brackets and quotes are looked at
+     */
+    size_t JsonPushParser::skip(const string_view& chunk, size_t i, vector<Json>& values) {
+        const char c = chunk[i];
+
+        if (c == '"') {
+            _token = Token::Skipped;
+            return readString(chunk, i + 1, values);
+        }
+
+        if (c == '{' || c == '[')
+            _skipDepth++;
+        else if (c == '}' || c == ']')
+            _skipDepth--;
+
+        return i + 1;
+    }
+
+    /**
+     * Consumes a chunk
+     */
+    vector<Json> JsonPushParser::feed(string_view chunk) {
+        vector<Json> values;
+        size_t i = 0;
+
+        /**
+         * The token split by the end of the previous chunk goes on
+         */
+        if (_token == Token::Scalar)
+            i = readScalar(chunk, 0, values);
+        else if (_token != Token::None)
+            i = readString(chunk, 0, values);
+
+        while (i < chunk.size())
+            i = _skipDepth > 0 ? skip(chunk, i, values) : step(chunk, i, values);
+
+        _offset += chunk.size();
+        return values;
+    }
+
+    /**
+     * Ends the input
+     */
+    vector<Json> JsonPushParser::finish() {
+        vector<Json> values;
+
+        if (_token == Token::Scalar) {
+            _token = Token::None;
+            completeScalar(_pending, '\0', values);
+        }
+        else if (_token != Token::None) {
+            if (_token != Token::Skipped)
+                _reporter.ReportUnexpectedChar('\0', _offset, '"', "End of a string");
+
+            Token token = _token;
+            _token = Token::None;
+            if (token == Token::String) {
+                _builder.onString(_pending);
+                completed(values);
+            }
+        }
+        _pending.clear();
+
+        if (!_containers.empty()) {
+            const bool object = _containers.back().object;
+            _reporter.ReportUnexpectedChar('\0', _offset, object ? '}' : ']', object ? "End of an object" : "End of an array");
+
+            while (!_containers.empty())
+                endContainer(values);
+        }
+
+        _expect = Expect::Value;
+        _skipDepth = 0;
+        _offset = 0;
+        return values;
+    }
+
+} // namespace JsonSer
@@ -0,0 +1,171 @@
+#ifndef JSON_PUSH_PARSER_API
+#define JSON_PUSH_PARSER_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+#include "JsonScanner.h"
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A resumable parser for input that arrives in chunks
+     *
+     * The values are built while the chunks arrive: the parser keeps the
+     * containers being built and what it expects next, each chunk moves
+     * the parsing forward and the top-level values are returned as soon
+     * as they close. Only the bytes of a string, a number or a literal
+     * split across chunks are kept, strings and numbers are scanned by
+     * the JsonScanner (the grammar is the one of the JsonReader)
+     *
+     * After a syntax error the open containers are closed (the value
+     * built so far is returned) and the rest of the value is skipped.
+     * The positions of the diagnostics are positions in the whole stream
+     */
+    class JsonPushParser {
+
+        /**
+         * What the parser expects next
+         * - Value: a value (top level, after ':' or ',' in an array)
+         * - FirstElement: a value or the end of an empty array
+         * - FirstKey: a key or the end of an empty object
+         * - Key: a key (after ',' in an object)
+         * - Colon: the ':' after a key
+         * - Separator: a ',' or the end of the container
+         */
+        enum class Expect : uint8_t
+        {
+            Value,
+            FirstElement,
+            FirstKey,
+            Key,
+            Colon,
+            Separator
+        };
+
+        /**
+         * The token being read, it can span several chunks
+         */
+        enum class Token : uint8_t
+        {
+            None,
+            String,
+            Key,
+            Scalar,
+            Skipped
+        };
+
+        struct Container
+        {
+            bool object;
+            size_t count;
+        };
+
+        Json::TreeBuilder _builder;
+        vector<Container> _containers;
+        Expect _expect = Expect::Value;
+
+        Token _token = Token::None;
+
+        /**
+         * Bytes of the current token seen in previous
+         * chunks and its position in the stream
+         */
+        string _pending;
+        size_t _tokenStart = 0;
+
+        /**
+         * Depth of the value being skipped after
+         * an error (0 when nothing is skipped)
+         */
+        size_t _skipDepth = 0;
+
+        /**
+         * Position of the current chunk in the stream
+         */
+        size_t _offset = 0;
+
+        Json::Reporter _reporter;
+
+        /**
+         * Chars that end a number or a literal
+         */
+        static bool isDelimiter(const char&);
+
+        /**
+         * Reads the token started at <position> in the <chunk> (or in a
+         * previous chunk), returns the position after it or the end of
+         * the chunk if the token goes on in the next one
+         */
+        size_t readString(const string_view&, size_t, vector<Json>&);
+        size_t readScalar(const string_view&, size_t, vector<Json>&);
+
+        /**
+         * Reads a whole number or literal followed by <next>
+         */
+        void completeScalar(const string_view&, const char& next, vector<Json>&);
+
+        /**
+         * Reads the char at <position>, returns the position of
+         * the next char to read
+         */
+        size_t step(const string_view&, size_t, vector<Json>&);
+        size_t skip(const string_view&, size_t, vector<Json>&);
+
+        /**
+         * Builder events, the value just added or closed
+         * is completed, a top-level one is returned
+         */
+        void startContainer(const bool& object);
+        void endContainer(vector<Json>&);
+        void completed(vector<Json>&);
+
+        /**
+         * Reports the unexpected <current> char at <position> (in the
+         * stream), then closes the open containers and skips the rest of
+         * the value. An error at the top level gives an undefined value
+         */
+        void fail(const char& current, const size_t& position, const char& expected, const string& additional, vector<Json>&);
+
+        /**
+         * Reports the <current> char, unexpected in the state of the parser
+         */
+        void unexpected(const char& current, const size_t& position, vector<Json>&);
+
+        public: /**************** public members ****************/
+
+        /**
+         * The <options> are the ones of Json::fromString
+         * (lazy, threads and stats are ignored)
+         */
+        JsonPushParser(const Json::ParseOptions& = Json::ParseOptions());
+
+        /**
+         * Consumes a chunk, returns the top-level
+         * values that have been closed by it
+         */
+        vector<Json> feed(string_view);
+
+        /**
+         * Ends the input, returns the last value if any (an unterminated
+         * value is reported and closed). A new stream can then be fed
+         */
+        vector<Json> finish();
+
+        /**
+         * Returns true if a value is waiting for more input
+         */
+        bool isInsideValue() const { return !_containers.empty() || _token != Token::None || _skipDepth > 0; }
+
+        /**
+         * Diagnostic property
+         */
+        vector<string>& Diagnostics() { return _reporter.Diagnostics(); }
+    };
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,605 @@
+#ifndef JSON_READER_API
+#define JSON_READER_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+#include "ParseStats.h"
+#include "JsonScanner.h"
+#include "StructuralIndex.h"
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A handler that ignores every event, handlers can
+     * inherit from it and only define the events they need
+     *
+     * Every event returns false to stop the parsing
+     */
+    struct JsonHandler
+    {
+        bool onNull() { return true; }
+        bool onUndefined() { return true; }
+        bool onInt(long long) { return true; }
+        bool onFloat(double) { return true; }
+        bool onBool(bool) { return true; }
+        bool onString(string_view) { return true; }
+        bool onStartObject() { return true; }
+        bool onKey(string_view) { return true; }
+        bool onEndObject(size_t) { return true; }
+        bool onStartArray() { return true; }
+        bool onEndArray(size_t) { return true; }
+        bool onSkipped(string_view) { return true; }
+    };
+
+    /**
+     * The grammar of the json format
+     *
+     * Values are not built, they are reported to the <Handler>
+     * (strings and keys are views of the input), the handler
+     * decides what to keep. After an error the open containers
+     * are still closed, so the handler sees balanced events
+     *
+     * A shallow parse doesn't descend into the containers below a depth,
+     * each one of them is reported whole (onSkipped) after a scan that
+     * only balances brackets and quotes
+     *
+     * The <Stats> (NoParseStats by default, see ParseStats.h) are told
+     * about the values, the depth and the time of each phase
+     */
+    template<class Handler, class Stats>
+    class JsonReader {
+
+        size_t _position = 0;
+
+        /**
+         * The input is owned by the caller, the reader
+         * only looks at it
+         */
+        string_view _text;
+
+        /**
+         * Positions of the structural chars of <_text>
+         * and the first one not visited yet
+         */
+        StructuralIndex _index;
+        size_t _cursor = 0;
+
+        Handler& _handler;
+
+        Json::Reporter _reporter;
+
+        /**
+         * Depth of the current container and the depth
+         * from which containers are skipped
+         */
+        size_t _depth = 0;
+        size_t _skipDepth = (size_t)-1;
+
+        Stats _stats;
+
+        /**
+         * Returns the char of the <_text>
+         * at position <_position>
+         */
+        char current();
+
+        /**
+         * Increments position by 1
+         */
+        void next();
+
+        /**
+         * Position of the first structural char
+         * at or after <_position>
+         */
+        size_t nextIndexed();
+
+        /**
+         * Ignore whitespace
+         */
+        void ignoreWhiteSpace();
+
+        /**
+         * Helper functions
+         */
+        bool startsWith(const string_view&);
+
+        /**
+         * Parsers, they return false when 
+         * the handler stops the parsing
+         */
+        bool parseNumber();
+        bool parseBool();
+        bool parseString();
+        bool parseObject();
+        bool parseArray();
+        bool parseElements(size_t count);
+        bool skipContainer();
+        string_view getParsedString();
+        bool getKeyValue();
+
+        public: /**************** public members ****************/
+
+        /**
+         *  Default constructor, the structural index
+         *  is only built if <indexed>
+         */
+        JsonReader(string_view, Handler&, bool indexed = true);
+
+        /**
+         * Parses one value, returns false 
+         * if the handler stopped the parsing
+         */
+        bool parse();
+
+        /**
+         * Parses one value, the containers at <depth> or
+         * deeper are reported whole (0 skips the value itself)
+         */
+        bool parseShallow(size_t depth);
+
+        /**
+         * Parses the rest of the array whose element starts at <position>,
+         * after its <count> first elements (which the handler doesn't see).
+         * The end of the array is reported as onEndArray
+         */
+        bool resumeArray(size_t position, size_t count);
+
+        /**
+         * Returns true if only whitespace is left after the parsed value
+         */
+        bool isAtEnd();
+
+        /**
+         * Reports the content left after a value parsed
+         * without errors, returns false if there is some
+         */
+        bool expectEnd();
+
+        /**
+         * Position of the next char to read
+         */
+        size_t position() const { return _position; }
+
+        /**
+         * The structural index of the text
+         */
+        const StructuralIndex& Index() const { return _index; }
+
+        vector<string>& Diagnostics() { return _reporter.Diagnostics(); }
+
+        /**
+         * Statistics of the values parsed so far
+         */
+        const Stats& Statistics() {
+            _stats.finish(_position, _reporter.Diagnostics().size());
+            return _stats;
+        }
+
+    };
+
+
+    /************************** Json Reader **************************/
+
+    /**
+     * Default constructor 
+     */
+    template<class Handler, class Stats>
+    JsonReader<Handler, Stats>::JsonReader(string_view text, Handler& handler, bool indexed) 
+        :_text(text), _handler(handler)
+    {
+        if (indexed) {
+            auto stamp = _stats.start();
+            _index.build(_text);
+            _stats.scanned(stamp);
+        }
+    }
+
+    /**
+     * Get the current char
+     */
+    template<class Handler, class Stats>
+    char JsonReader<Handler, Stats>::current() {
+        if (_position >= _text.size())
+            return '\0';
+        return _text[_position];
+    }
+
+    /**
+     * Next position
+     */
+    template<class Handler, class Stats>
+    void JsonReader<Handler, Stats>::next() {
+        _position++;
+    }
+
+    /**
+     * Next structural char, the cursor only moves
+     * forward since the position never goes back
+     */
+    template<class Handler, class Stats>
+    size_t JsonReader<Handler, Stats>::nextIndexed() {
+        const auto& positions = _index.Positions();
+
+        while (_cursor < positions.size() && positions[_cursor] < _position)
+            _cursor++;
+
+        if (_cursor == positions.size())
+            return _text.size();
+        return positions[_cursor];
+    }
+
+    /**
+     * Ignore whitespace
+     */
+    template<class Handler, class Stats>
+    void JsonReader<Handler, Stats>::ignoreWhiteSpace() {
+        if (!JsonScanner::isWhiteSpace(current()))
+            return;
+
+        /**
+         * Everything between a whitespace and the
+         * next structural char is whitespace
+         */
+        if (_index.isBuilt()) {
+            _position = nextIndexed();
+            return;
+        }
+
+        while (JsonScanner::isWhiteSpace(current())) next();
+    }
+
+    /**
+     * returns true if the text at the current position
+     * starts with <word>
+     */
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::startsWith(const string_view& word) {
+        if (_position > _text.size())
+            return false;
+        return _text.substr(_position, word.size()) == word;
+    }
+    
+    /**
+     * Parser methods for:
+     * <number>
+     * <bool>
+     * <string>
+     * <object>
+     * <array>
+     */
+
+    /**
+     * The number is scanned and converted by the JsonScanner
+     */
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::parseNumber() {
+        auto stamp = _stats.start();
+        JsonScanner::Number number = JsonScanner::scanNumber(_text, _position);
+
+        if (number.type == JsonScanner::Number::Type::Invalid) {
+            _position = number.errorPosition;
+            _reporter.ReportUnexpectedChar(current(), _position, '0', number.additional);
+            _position = number.end;
+            _stats.countValue(Json::JsonType::Undefined);
+            return _handler.onUndefined();
+        }
+
+        _position = number.end;
+        _stats.converted(stamp);
+
+        if (number.type == JsonScanner::Number::Type::Int) {
+            _stats.countValue(Json::JsonType::Int);
+            return _handler.onInt(number.integer);
+        }
+
+        _stats.countValue(Json::JsonType::Float);
+        return _handler.onFloat(number.floating);
+    }
+
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::parseBool() {
+        bool value = startsWith("true");
+
+        if(value) _position += 4;
+        else _position += 5;
+
+        _stats.countValue(Json::JsonType::Bool);
+        return _handler.onBool(value);
+    }
+    
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::parseString() {
+        string_view value = getParsedString();
+        _stats.countString(value.size());
+        return _handler.onString(value);
+    }
+
+    template<class Handler, class Stats>
+    string_view JsonReader<Handler, Stats>::getParsedString() {
+        next();
+        size_t start = _position;
+
+        /**
+         * The closing quote is the next structural char, the
+         * string is walked char by char only without an index
+         */
+        if (_index.isBuilt())
+            _position = nextIndexed();
+
+        if (_position >= _text.size() || current() != '"') {
+            size_t end = JsonScanner::endOfString(_text, start);
+
+            if (end == string_view::npos) {
+                _position = _text.size();
+                _reporter.ReportUnexpectedChar(current(), _position, '"', "End of a string");
+            }
+            else
+                _position = end - 1;
+        }
+
+        size_t length = _position - start;
+        
+        next();
+        return _text.substr(start, length);
+    }
+    
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::getKeyValue() {
+        if (current() != '"') {
+            _reporter.ReportUnexpectedChar(current(), _position, '"', "[KEY, value] of an object");
+            _position++;
+            _stats.countValue(Json::JsonType::Undefined);
+            return _handler.onKey("") && _handler.onUndefined();
+        }
+
+        string_view key = getParsedString();
+        _stats.countKey(key.size());
+        if (!_handler.onKey(key))
+            return false;
+
+        ignoreWhiteSpace();
+
+        if (current() != ':') {
+            _reporter.ReportUnexpectedChar(current(), _position, ':', "[key, value] of an object");
+            _position++;
+            _stats.countValue(Json::JsonType::Undefined);
+            return _handler.onUndefined();
+        }
+
+        next();
+        return parse();
+    }
+
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::parseObject() {
+        size_t count = 0;
+
+        if (_depth >= _skipDepth)
+            return skipContainer();
+
+        _stats.countValue(Json::JsonType::Object);
+        auto stamp = _stats.start();
+        bool started = _handler.onStartObject();
+        _stats.built(stamp);
+        if (!started)
+            return false;
+
+        _depth++;
+        _stats.reachDepth(_depth);
+        next();
+        while ( true ) {
+
+            ignoreWhiteSpace();
+
+            /**
+             * An empty object
+             */
+            if (count == 0 && current() == '}') {
+                next();
+                break;
+            }
+
+            if (!getKeyValue())
+                return false;
+            count++;
+            ignoreWhiteSpace();
+
+            char curr = current();
+
+            if ( curr == ',' ) {
+                next();
+                continue;
+            }
+            
+            else if( curr == '}' ) {
+                next();
+                break;
+            }
+
+            else {
+                _reporter.ReportUnexpectedChar(current(), _position, '}', "End of an object");
+                break;
+            }
+
+        }
+        _depth--;
+        stamp = _stats.start();
+        bool ended = _handler.onEndObject(count);
+        _stats.built(stamp);
+        return ended;
+    }
+    
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::parseArray()  {
+        if (_depth >= _skipDepth)
+            return skipContainer();
+
+        _stats.countValue(Json::JsonType::Array);
+        auto stamp = _stats.start();
+        bool started = _handler.onStartArray();
+        _stats.built(stamp);
+        if (!started)
+            return false;
+
+        _depth++;
+        _stats.reachDepth(_depth);
+        next();
+        return parseElements(0);
+    }
+
+    /**
+     * The elements of the array at <_depth> from the current
+     * position, after <count> elements, and its end
+     */
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::parseElements(size_t count) {
+        while ( true ) {
+
+            ignoreWhiteSpace();
+
+            /**
+             * An empty array
+             */
+            if (count == 0 && current() == ']') {
+                next();
+                break;
+            }
+
+            if (!parse())
+                return false;
+            count++;
+
+            ignoreWhiteSpace();
+
+            char curr = current();
+
+            if ( curr == ',' ) {
+                next();
+                continue;
+            }
+            
+            else if( curr == ']' ) {
+                next();
+                break;
+            }
+
+            else {
+                _reporter.ReportUnexpectedChar(current(), _position, ']', "End of an array");
+                _position++;
+                break;
+            }
+
+        }
+
+        _depth--;
+        auto stamp = _stats.start();
+        bool ended = _handler.onEndArray(count);
+        _stats.built(stamp);
+        return ended;
+    }
+
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::resumeArray(size_t position, size_t count) {
+        _position = position;
+        _depth++;
+        _stats.reachDepth(_depth);
+        return parseElements(count);
+    }
+
+    /**
+     * Finds the end of the container at the current position, 
+     * only brackets and quotes are looked at
+     */
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::skipContainer() {
+        const char* text = _text.data();
+        const size_t size = _text.size();
+        const size_t start = _position;
+        size_t depth = 0;
+
+        while (_position < size) {
+            const char c = text[_position++];
+
+            if (c == '"') {
+                _position = JsonScanner::endOfString(_text, _position);
+                if (_position == string_view::npos)
+                    _position = size;
+            }
+            else if (c == '{' || c == '[')
+                depth++;
+            else if ((c == '}' || c == ']') && --depth == 0)
+                break;
+        }
+
+        if (depth != 0)
+            _reporter.ReportUnexpectedChar(current(), _position, text[start] == '{' ? '}' : ']', "End of a skipped container");
+
+        _stats.countValue(text[start] == '{' ? Json::JsonType::Object : Json::JsonType::Array);
+        return _handler.onSkipped(_text.substr(start, _position - start));
+    }
+    
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::isAtEnd() {
+        while (JsonScanner::isWhiteSpace(current()))
+            next();
+        return _position >= _text.size();
+    }
+
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::expectEnd() {
+        if (!_reporter.Diagnostics().empty() || isAtEnd())
+            return true;
+
+        _reporter.ReportUnexpectedChar(current(), _position, ' ', "Nothing after the value");
+        return false;
+    }
+
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::parseShallow(size_t depth) {
+        _skipDepth = depth;
+        return parse();
+    }
+
+    /**
+     * The parse method - the core of all
+     */
+    template<class Handler, class Stats>
+    bool JsonReader<Handler, Stats>::parse() {
+        
+        ignoreWhiteSpace();
+
+        if ( JsonScanner::isDigit(current()) || current() == '-' )
+            return parseNumber();
+        
+        switch (current()) {
+            case '"':
+                return parseString();
+            case '{':
+                return parseObject();
+            case '[':
+                return parseArray();
+        }
+
+        if (startsWith("true") || startsWith("false"))
+            return parseBool();
+
+        else if (startsWith("null"))
+            return _position += 4, _stats.countValue(Json::JsonType::Null), _handler.onNull();
+
+        else if( startsWith("undefined") )
+            return _position += 9, _stats.countValue(Json::JsonType::Undefined), _handler.onUndefined();
+
+        _reporter.ReportUnexpectedChar(current(), _position, '@', "Any valid json value");
+        _stats.countValue(Json::JsonType::Undefined);
+        return _handler.onUndefined();
+
+    }
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,240 @@
+#ifndef JSON_SCANNER_API
+#define JSON_SCANNER_API
+
+/**
+ * Libraries
+ */
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * The lexical part of the grammar: whitespace, the end of a string
+     * and numbers. Every reader of the library (JsonReader, JsonCursor,
+     * JsonPushParser, Json::splitRecords) scans with it, so they all
+     * accept the same strings and numbers
+     */
+    class JsonScanner {
+
+        public: /**************** public members ****************/
+
+        static bool isDigit(const char& c) { return c >= '0' && c <= '9'; }
+        static bool isWhiteSpace(const char& c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+        /**
+         * Position after the quote that ends the string, npos if the
+         * <text> ends first. <position> is after the opening quote, or
+         * anywhere inside the string that isn't right after a backslash
+         *
+         * A quote ends the string unless it is preceded by an odd
+         * number of backslashes (the ones after <position>)
+         */
+        static size_t endOfString(string_view text, size_t position) {
+            const char* data = text.data();
+            const char* start = data + position;
+            const size_t size = text.size();
+
+            while (position < size) {
+                const char* quote = (const char*)memchr(data + position, '"', size - position);
+                if (!quote)
+                    return string_view::npos;
+
+                size_t backslashes = 0;
+                while (quote - backslashes > start && quote[-(ptrdiff_t)backslashes - 1] == '\\')
+                    backslashes++;
+
+                position = quote - data + 1;
+                if (backslashes % 2 == 0)
+                    return position;
+            }
+            return string_view::npos;
+        }
+
+        /**
+         * A scanned number, an int that doesn't fit
+         * in a long long is a float
+         */
+        struct Number
+        {
+            enum class Type : uint8_t { Int, Float, Invalid };
+
+            Type type = Type::Invalid;
+            long long integer = 0;
+            double floating = 0;
+
+            /**
+             * Position after the number, or where the
+             * scanning stopped for an invalid one
+             */
+            size_t end = 0;
+
+            /**
+             * What an invalid number is missing and where,
+             * as reported by Json::Reporter (expecting a '0')
+             */
+            size_t errorPosition = 0;
+            const char* additional = "";
+
+            double toDouble() const { return type == Type::Int ? (double)integer : floating; }
+        };
+
+        /**
+         * Numbers are read in a single pass: up to 19 digits are
+         * accumulated in the mantissa while the chars are scanned
+         */
+        static Number scanNumber(string_view text, size_t position) {
+            /**
+             * Powers of ten that are exact in a double
+             */
+            static const double exactPowersOfTen[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+
+            const char* data = text.data();
+            const size_t size = text.size();
+            auto at = [&](size_t i) { return i < size ? data[i] : '\0'; };
+
+            Number number;
+            auto invalid = [&](size_t errorPosition, const char* additional) {
+                number.type = Number::Type::Invalid;
+                number.end = position;
+                number.errorPosition = errorPosition;
+                number.additional = additional;
+                return number;
+            };
+
+            const size_t start = position;
+            bool negative = at(position) == '-';
+            if (negative)
+                position++;
+
+            uint64_t mantissa = 0;
+            int digits = 0;
+            const size_t integerStart = position;
+
+            while (isDigit(at(position))) {
+                if (digits < 19)
+                    mantissa = mantissa * 10 + (data[position] - '0');
+                digits++;
+                position++;
+            }
+
+            if (digits == 0)
+                return invalid(position, "Digits of a number");
+
+            /**
+             * A 0 is the whole int part, json has no leading zeros
+             */
+            if (data[integerStart] == '0' && digits > 1)
+                return invalid(integerStart + 1, "A number without leading zeros");
+
+            char c = at(position);
+            if (c != '.' && c != 'e' && c != 'E') {
+                number.end = position;
+                number.type = Number::Type::Int;
+                number.integer = negative ? -(long long)mantissa : (long long)mantissa;
+
+                /**
+                 * Too big for the fast path, the ints that
+                 * don't fit in a long long become floats
+                 */
+                if (digits < 19 || from_chars(data + start, data + position, number.integer).ec == errc())
+                    return number;
+            }
+
+            int fraction = 0;
+            int exponent = 0;
+
+            /**
+             * The zeros between the point and the first
+             * significant digit of a number below 1
+             */
+            long long leadingZeros = 0;
+            const long long integerDigits = data[integerStart] == '0' ? 0 : digits;
+
+            if (at(position) == '.') {
+                position++;
+                if (!isDigit(at(position)))
+                    return invalid(position, "Digits of a fraction");
+
+                bool significant = integerDigits > 0;
+                while (isDigit(at(position))) {
+                    significant = significant || data[position] != '0';
+                    if (!significant)
+                        leadingZeros++;
+
+                    if (digits < 19) {
+                        mantissa = mantissa * 10 + (data[position] - '0');
+                        fraction++;
+                    }
+                    digits++;
+                    position++;
+                }
+            }
+
+            if (at(position) == 'e' || at(position) == 'E') {
+                position++;
+                bool negativeExponent = at(position) == '-';
+                if (at(position) == '-' || at(position) == '+')
+                    position++;
+
+                if (!isDigit(at(position)))
+                    return invalid(position, "Digits of an exponent");
+
+                while (isDigit(at(position))) {
+                    if (exponent < 100000)
+                        exponent = exponent * 10 + (data[position] - '0');
+                    position++;
+                }
+                if (negativeExponent)
+                    exponent = -exponent;
+            }
+
+            number.end = position;
+            number.type = Number::Type::Float;
+
+            /**
+             * Fast path: an exact mantissa and an exact power of ten
+             * give a correctly rounded result with a single operation
+             */
+            int power = exponent - fraction;
+
+            if (digits <= 19 && mantissa <= (uint64_t(1) << 53) && power >= -22 && power <= 22) {
+                double value = (double)mantissa;
+                if (power < 0) value /= exactPowersOfTen[-power];
+                else value *= exactPowersOfTen[power];
+                number.floating = negative ? -value : value;
+                return number;
+            }
+
+            auto result = from_chars(data + start, data + position, number.floating);
+
+            /**
+             * Out of range is an overflow or an underflow, told apart by the
+             * decimal exponent of the first significant digit. Only the
+             * overflow is an error (a tiny number rounds to a signed zero)
+             */
+            if (result.ec == errc::result_out_of_range) {
+                if (exponent + integerDigits - leadingZeros > 0)
+                    return invalid(start, "A number in the range of a double");
+                number.floating = negative ? -0.0 : 0.0;
+            }
+            else if (result.ec != errc())
+                return invalid(start, "A number");
+
+            return number;
+        }
+    };
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,502 @@
+#include "JsonSchema.h"
+#include "JsonReader.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace JsonSer
+{
+
+    /************************** Json Schema Compiler **************************/
+
+    JsonSchema::JsonSchema(const Json& schema) {
+        _nodes.emplace_back();
+        _root = compile(schema, "$");
+    }
+
+    void JsonSchema::reportSchema(const string& path, const string& additional) {
+        _reporter.ReportInvalidSchema(path, additional);
+        _valid = false;
+    }
+
+    /**
+     * A node is added for every schema object, true is the node
+     * that accepts everything and false a node without types
+     */
+    size_t JsonSchema::compile(const Json& schema, const string& path) {
+        if (schema._type == Json::JsonType::Bool) {
+            if (schema.load<bool>())
+                return ANY;
+            _nodes.emplace_back();
+            _nodes.back().types = 0;
+            return _nodes.size() - 1;
+        }
+
+        if (schema._type != Json::JsonType::Object) {
+            reportSchema(path, "A schema object");
+            return ANY;
+        }
+
+        /**
+         * The node is accessed by its index, compiling
+         * the children adds nodes (and may move it)
+         */
+        const size_t index = _nodes.size();
+        _nodes.emplace_back();
+
+        for (const auto& member : schema.container()->_object) {
+            const string_view keyword = member.first;
+            const Json& value = member.second;
+            const string at = path + "." + string(keyword);
+
+            if (keyword == "type") {
+                uint8_t types = compileType(value, at);
+                _nodes[index].types = types;
+            }
+            else if (keyword == "enum") {
+                compileEnum(_nodes[index], value, at);
+            }
+            else if (keyword == "minimum") {
+                double minimum = 0;
+                _nodes[index].hasMinimum = compileNumber(value, at, minimum);
+                _nodes[index].minimum = minimum;
+            }
+            else if (keyword == "maximum") {
+                double maximum = 0;
+                _nodes[index].hasMaximum = compileNumber(value, at, maximum);
+                _nodes[index].maximum = maximum;
+            }
+            else if (keyword == "maxLength") {
+                if (value._type != Json::JsonType::Int || value.load<long long>() < 0)
+                    reportSchema(at, "A length (an int >= 0)");
+                else
+                    _nodes[index].maxLength = (size_t)value.load<long long>();
+            }
+            else if (keyword == "items") {
+                size_t items = compile(value, at);
+                _nodes[index].items = items;
+            }
+            else if (keyword == "properties") {
+                if (value._type != Json::JsonType::Object) {
+                    reportSchema(at, "An object of schemas");
+                    continue;
+                }
+
+                for (const auto& property : value.container()->_object) {
+                    size_t node = compile(property.second, at + "." + string(property.first.view()));
+                    auto& properties = _nodes[index].properties;
+
+                    auto found = find_if(properties.begin(), properties.end(),
+                        [&](const Property& known) { return known.name == property.first.view(); });
+                    if (found == properties.end())
+                        properties.push_back({ string(property.first.view()), node, false });
+                    else
+                        found->node = node;
+                }
+            }
+            else if (keyword == "required") {
+                if (value._type != Json::JsonType::Array) {
+                    reportSchema(at, "An array of member names");
+                    continue;
+                }
+
+                for (const Json& name : value.container()->_array) {
+                    if (name._type != Json::JsonType::String) {
+                        reportSchema(at, "A member name");
+                        continue;
+                    }
+
+                    auto& properties = _nodes[index].properties;
+                    auto found = find_if(properties.begin(), properties.end(),
+                        [&](const Property& known) { return known.name == name.stringView(); });
+                    if (found == properties.end())
+                        properties.push_back({ string(name.stringView()), ANY, true });
+                    else
+                        found->required = true;
+                }
+            }
+        }
+
+        return index;
+    }
+
+    uint8_t JsonSchema::compileType(const Json& type, const string& path) {
+        if (type._type == Json::JsonType::Array) {
+            uint8_t types = 0;
+            for (const Json& name : type.container()->_array)
+                types |= compileType(name, path);
+            return types;
+        }
+
+        const string_view name = type.stringView();
+        if (type._type == Json::JsonType::String) {
+            if (name == "null") return NULL_TYPE;
+            if (name == "boolean") return BOOL_TYPE;
+            if (name == "integer") return INTEGER_TYPE;
+            if (name == "number") return NUMBER_TYPE;
+            if (name == "string") return STRING_TYPE;
+            if (name == "object") return OBJECT_TYPE;
+            if (name == "array") return ARRAY_TYPE;
+        }
+
+        reportSchema(path, "A type name (null, boolean, integer, number, string, object, array)");
+        return ANY_TYPE;
+    }
+
+    void JsonSchema::compileEnum(Node& node, const Json& values, const string& path) {
+        if (values._type != Json::JsonType::Array) {
+            reportSchema(path, "An array of values");
+            return;
+        }
+
+        for (const Json& value : values.container()->_array) {
+            if (value._type == Json::JsonType::Object || value._type == Json::JsonType::Array)
+                reportSchema(path, "A scalar value (containers aren't supported)");
+            else
+                node.values.push_back(value);
+        }
+    }
+
+    bool JsonSchema::compileNumber(const Json& number, const string& path, double& value) {
+        if (number._type == Json::JsonType::Int)
+            value = (double)number.load<long long>();
+        else if (number._type == Json::JsonType::Float)
+            value = number.load<double>();
+        else {
+            reportSchema(path, "A number");
+            return false;
+        }
+        return true;
+    }
+
+
+    /************************** Json Schema Validator **************************/
+
+    /**
+     * Each event is checked against the node of its value before it is
+     * passed to the builder. After the first violation every event
+     * returns false and the reader stops
+     */
+    template<class Builder>
+    class JsonSchema::Validator {
+
+        /**
+         * An open container: its node, the key (or the number of
+         * elements) reached and the node of the next member
+         */
+        struct Frame
+        {
+            size_t node;
+            bool array;
+            string_view key;
+            size_t elements;
+            size_t next;
+
+            /**
+             * Offset of the flags of the properties seen in <_seen>
+             */
+            size_t seen;
+        };
+
+        const JsonSchema& _schema;
+        Builder& _builder;
+
+        vector<Frame> _frames;
+        vector<uint8_t> _seen;
+
+        bool _failed = false;
+        string _path;
+        string _violation;
+
+        /**
+         * Node of the value the reader has reached
+         */
+        const Node& enter() {
+            if (_frames.empty())
+                return _schema._nodes[_schema._root];
+
+            Frame& parent = _frames.back();
+            if (!parent.array)
+                return _schema._nodes[parent.next];
+
+            parent.elements++;
+            return _schema._nodes[_schema._nodes[parent.node].items];
+        }
+
+        /**
+         * Records the violation at the path of the first <depth> containers
+         */
+        bool fail(const string& violation, size_t depth) {
+            _path = "$";
+            for (size_t i = 0; i < depth; i++) {
+                if (_frames[i].array)
+                    _path += "[" + to_string(_frames[i].elements - 1) + "]";
+                else
+                    _path += "." + string(_frames[i].key);
+            }
+
+            _violation = violation;
+            _failed = true;
+            return false;
+        }
+
+        bool fail(const string& violation) { return fail(violation, _frames.size()); }
+
+        static string typeNames(uint8_t types) {
+            static const char* names[] = { "null", "boolean", "integer", "number", "string", "object", "array" };
+
+            string text;
+            for (int i = 0; i < 7; i++)
+                if (types & (1 << i))
+                    text += (text.empty() ? "" : "|") + string(names[i]);
+            return text.empty() ? "No value (the schema is false)" : "A value of type " + text;
+        }
+
+        bool checkType(const Node& node, uint8_t type) {
+            return (node.types & type) || fail(typeNames(node.types));
+        }
+
+        /**
+         * The value must be one of the <values> of the
+         * node for which <equals> returns true
+         */
+        template<class Equals>
+        bool checkEnum(const Node& node, Equals equals) {
+            if (node.values.empty())
+                return true;
+            for (const Json& value : node.values)
+                if (equals(value))
+                    return true;
+            return fail("A value of the enum");
+        }
+
+        bool checkRange(const Node& node, double value) {
+            if (node.hasMinimum && !(value >= node.minimum))
+                return fail("A value >= " + Json(node.minimum).toString());
+            if (node.hasMaximum && !(value <= node.maximum))
+                return fail("A value <= " + Json(node.maximum).toString());
+            return true;
+        }
+
+        /**
+         * Chars of a string as it is stored (with its escapes):
+         * an escape or a UTF-8 sequence is one char
+         */
+        static size_t length(string_view text) {
+            size_t chars = 0;
+            for (size_t i = 0; i < text.size(); chars++) {
+                if (text[i] == '\\')
+                    i += i + 1 < text.size() && text[i + 1] == 'u' ? 6 : 2;
+                else {
+                    i++;
+                    while (i < text.size() && ((uint8_t)text[i] & 0xC0) == 0x80)
+                        i++;
+                }
+            }
+            return chars;
+        }
+
+        static bool equalNumbers(const Json& value, double number) {
+            if (value._type == Json::JsonType::Int)
+                return (double)value.load<long long>() == number;
+            return value._type == Json::JsonType::Float && value.load<double>() == number;
+        }
+
+        public: /**************** public members ****************/
+
+        Validator(const JsonSchema& schema, Builder& builder) :_schema(schema), _builder(builder) { }
+
+        bool failed() const { return _failed; }
+        const string& path() const { return _path; }
+        const string& violation() const { return _violation; }
+
+        bool onNull() {
+            if (_failed)
+                return false;
+
+            const Node& node = enter();
+            return checkType(node, NULL_TYPE) &&
+                checkEnum(node, [](const Json& value) { return value._type == Json::JsonType::Null; }) &&
+                _builder.onNull();
+        }
+
+        /**
+         * Undefined isn't a type of the schemas,
+         * only the schemas without rules accept it
+         */
+        bool onUndefined() {
+            if (_failed)
+                return false;
+
+            const Node& node = enter();
+            return checkType(node, node.types == ANY_TYPE ? ANY_TYPE : 0) &&
+                checkEnum(node, [](const Json&) { return false; }) &&
+                _builder.onUndefined();
+        }
+
+        bool onInt(long long number) {
+            if (_failed)
+                return false;
+
+            const Node& node = enter();
+            return checkType(node, INTEGER_TYPE | NUMBER_TYPE) && checkRange(node, (double)number) &&
+                checkEnum(node, [&](const Json& value) { return equalNumbers(value, (double)number); }) &&
+                _builder.onInt(number);
+        }
+
+        /**
+         * A float without a fraction is an integer
+         */
+        bool onFloat(double number) {
+            if (_failed)
+                return false;
+
+            const Node& node = enter();
+            uint8_t type = number == floor(number) ? INTEGER_TYPE | NUMBER_TYPE : NUMBER_TYPE;
+            return checkType(node, type) && checkRange(node, number) &&
+                checkEnum(node, [&](const Json& value) { return equalNumbers(value, number); }) &&
+                _builder.onFloat(number);
+        }
+
+        bool onBool(bool boolean) {
+            if (_failed)
+                return false;
+
+            const Node& node = enter();
+            return checkType(node, BOOL_TYPE) &&
+                checkEnum(node, [&](const Json& value) { return value._type == Json::JsonType::Bool && value.load<bool>() == boolean; }) &&
+                _builder.onBool(boolean);
+        }
+
+        bool onString(string_view text) {
+            if (_failed)
+                return false;
+
+            const Node& node = enter();
+            if (!checkType(node, STRING_TYPE))
+                return false;
+            if (node.maxLength != (size_t)-1 && length(text) > node.maxLength)
+                return fail("A string of at most " + to_string(node.maxLength) + " chars");
+
+            return checkEnum(node, [&](const Json& value) { return value._type == Json::JsonType::String && value.stringView() == text; }) &&
+                _builder.onString(text);
+        }
+
+        bool onStartObject() {
+            if (_failed)
+                return false;
+
+            const Node& node = enter();
+            if (!checkType(node, OBJECT_TYPE) || !checkEnum(node, [](const Json&) { return false; }))
+                return false;
+
+            _frames.push_back({ (size_t)(&node - _schema._nodes.data()), false, string_view(), 0, ANY, _seen.size() });
+            _seen.resize(_seen.size() + node.properties.size(), 0);
+            return _builder.onStartObject();
+        }
+
+        bool onKey(string_view key) {
+            if (_failed)
+                return false;
+
+            Frame& frame = _frames.back();
+            const auto& properties = _schema._nodes[frame.node].properties;
+
+            frame.key = key;
+            frame.next = ANY;
+            for (size_t i = 0; i < properties.size(); i++) {
+                if (properties[i].name == key) {
+                    frame.next = properties[i].node;
+                    _seen[frame.seen + i] = 1;
+                    break;
+                }
+            }
+            return _builder.onKey(key);
+        }
+
+        bool onEndObject(size_t count) {
+            if (_failed)
+                return false;
+
+            const Frame& frame = _frames.back();
+            const auto& properties = _schema._nodes[frame.node].properties;
+
+            for (size_t i = 0; i < properties.size(); i++)
+                if (properties[i].required && !_seen[frame.seen + i])
+                    return fail("The required member '" + properties[i].name + "'", _frames.size() - 1);
+
+            _seen.resize(frame.seen);
+            _frames.pop_back();
+            return _builder.onEndObject(count);
+        }
+
+        bool onStartArray() {
+            if (_failed)
+                return false;
+
+            const Node& node = enter();
+            if (!checkType(node, ARRAY_TYPE) || !checkEnum(node, [](const Json&) { return false; }))
+                return false;
+
+            _frames.push_back({ (size_t)(&node - _schema._nodes.data()), true, string_view(), 0, ANY, _seen.size() });
+            return _builder.onStartArray();
+        }
+
+        bool onEndArray(size_t count) {
+            if (_failed)
+                return false;
+
+            _frames.pop_back();
+            return _builder.onEndArray(count);
+        }
+
+        /**
+         * The reader only skips containers in a shallow
+         * parsing, which the validation doesn't do
+         */
+        bool onSkipped(string_view) { return false; }
+    };
+
+    template<class Builder>
+    bool JsonSchema::run(string_view text, Builder& builder, vector<string>& diagnostics) const {
+        if (!_valid) {
+            Json::Reporter reporter;
+            reporter.ReportInvalidSchema("$", "A schema that compiles (see its diagnostics)");
+            diagnostics.push_back(reporter.Diagnostics().back());
+            return false;
+        }
+
+        Validator<Builder> validator(*this, builder);
+        JsonReader<Validator<Builder>> reader(text, validator);
+        if (reader.parse())
+            reader.expectEnd();
+
+        auto& reported = reader.Diagnostics();
+        diagnostics.insert(diagnostics.end(), reported.begin(), reported.end());
+
+        /**
+         * The reader stopped right after the value that breaks the schema
+         */
+        if (validator.failed()) {
+            Json::Reporter reporter;
+            reporter.ReportInvalidValue(reader.position(), validator.path(), validator.violation());
+            diagnostics.push_back(reporter.Diagnostics().back());
+        }
+
+        return !validator.failed();
+    }
+
+    Json JsonSchema::parse(string_view text, vector<string>& diagnostics, const Json::ParseOptions& options) const {
+        Json::TreeBuilder builder(options);
+        if (!run(text, builder, diagnostics))
+            return Json();
+        return std::move(builder.Root());
+    }
+
+    bool JsonSchema::validate(string_view text, vector<string>& diagnostics) const {
+        JsonHandler handler;
+        size_t reported = diagnostics.size();
+        return run(text, handler, diagnostics) && diagnostics.size() == reported;
+    }
+
+} // namespace JsonSer
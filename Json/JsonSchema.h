@@ -0,0 +1,138 @@
+#ifndef JSON_SCHEMA_API
+#define JSON_SCHEMA_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A precompiled JSON Schema, checked while a document is parsed
+     *
+     * The keywords of the subset are "type" (a name or a list of names),
+     * "enum" (of scalars), "minimum", "maximum", "maxLength", "properties",
+     * "required" and "items" (one schema for every element). The other
+     * keywords are ignored, true is a schema that accepts everything
+     *
+     * The schema is compiled into a table of nodes that the reader walks
+     * with the document: each value is checked when the parser reaches it
+     * (required members at the end of their object). At the first violation
+     * the parsing stops, the violation is reported with its position and
+     * its path, and nothing more is built
+     *
+     *     JsonSchema schema(Json::fromString(R"({"type": "object", "required": ["id"]})"));
+     *     Json json = schema.parse(text, diagnostics);   // undefined if invalid
+     */
+    class JsonSchema {
+
+        /**
+         * Types of a node, one bit per type
+         */
+        static const uint8_t NULL_TYPE = 1, BOOL_TYPE = 2, INTEGER_TYPE = 4, NUMBER_TYPE = 8,
+            STRING_TYPE = 16, OBJECT_TYPE = 32, ARRAY_TYPE = 64, ANY_TYPE = 127;
+
+        /**
+         * The node 0 accepts everything (the members that aren't
+         * in "properties" and the elements without "items")
+         */
+        static const size_t ANY = 0;
+
+        struct Property
+        {
+            string name;
+            size_t node;
+            bool required;
+        };
+
+        /**
+         * A compiled schema
+         */
+        struct Node
+        {
+            uint8_t types = ANY_TYPE;
+
+            bool hasMinimum = false;
+            bool hasMaximum = false;
+            double minimum = 0;
+            double maximum = 0;
+
+            size_t maxLength = (size_t)-1;
+
+            /**
+             * Values of "enum", none when empty
+             */
+            vector<Json> values;
+
+            vector<Property> properties;
+            size_t items = ANY;
+        };
+
+        vector<Node> _nodes;
+        size_t _root = ANY;
+
+        Json::Reporter _reporter;
+        bool _valid = true;
+
+        /**
+         * Compiles the <schema> at <path>, returns its node
+         */
+        size_t compile(const Json& schema, const string& path);
+        uint8_t compileType(const Json& type, const string& path);
+        void compileEnum(Node& node, const Json& values, const string& path);
+        bool compileNumber(const Json& number, const string& path, double& value);
+        void reportSchema(const string& path, const string& additional);
+
+        /**
+         * Handler of the reader, checks the values before
+         * they are passed to the <Builder>
+         */
+        template<class Builder>
+        class Validator;
+
+        /**
+         * Runs the reader with a Validator of the <builder>, returns
+         * false if the document doesn't follow the schema
+         */
+        template<class Builder>
+        bool run(string_view text, Builder& builder, vector<string>& diagnostics) const;
+
+        public: /**************** public members ****************/
+
+        /**
+         * Compiles the <schema>, errors go to the diagnostics
+         */
+        JsonSchema(const Json& schema);
+
+        /**
+         * Returns false if the schema couldn't be compiled
+         * (such a schema rejects every document)
+         */
+        bool isValid() const { return _valid; }
+
+        /**
+         * Parses the <text> and checks it, returns undefined if it
+         * doesn't follow the schema. Syntax errors are reported as
+         * by Json::fromString, the <options> too are the ones of
+         * fromString (lazy, threads and stats are ignored)
+         */
+        Json parse(string_view text, vector<string>& diagnostics, const Json::ParseOptions& = Json::ParseOptions()) const;
+
+        /**
+         * Checks the <text> without building it, returns false if
+         * it doesn't follow the schema or has syntax errors
+         */
+        bool validate(string_view text, vector<string>& diagnostics) const;
+
+        /**
+         * Diagnostic property
+         */
+        vector<string>& Diagnostics() { return _reporter.Diagnostics(); }
+    };
+
+} // namespace JsonSer
+
+#endif
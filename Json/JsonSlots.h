@@ -0,0 +1,226 @@
+#ifndef JSON_SLOTS_API
+#define JSON_SLOTS_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+#include "JsonKeySet.h"
+#include "JsonReader.h"
+
+#include <bitset>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * An object whose known keys are slots of an array
+     *
+     * The parser routes each member of the top-level object through the
+     * perfect hash of a JsonKeySet: the value of a known key goes to the
+     * slot of the key, the other members go to an overflow object. The
+     * members are not hashed into an object and accessing a known key
+     * is an array index
+     *
+     *     constexpr auto keys = makeKeySet("host", "port");
+     *     constexpr size_t PORT = keys.find("port");
+     *
+     *     JsonSlots config(keys);
+     *     config.fromString(text);
+     *     long long port = config[PORT];
+     *
+     * A missing key leaves its slot undefined, a repeated key keeps
+     * its first value (as an object does, even an undefined one)
+     */
+    template<size_t N>
+    class JsonSlots {
+
+        const JsonKeySet<N>* _keys;
+
+        array<Json, N> _slots;
+        Json::Object _overflow;
+
+        /**
+         * The slots whose key was in the parsed object
+         */
+        bitset<N> _present;
+
+        /**
+         * The handler of the reader: the members of the top-level object
+         * are routed, their values are built by a Json::TreeBuilder
+         */
+        class Router {
+
+            JsonSlots& _target;
+            Json::TreeBuilder _builder;
+            pmr::memory_resource* _resource;
+
+            size_t _depth = 0;
+            string_view _key;
+            size_t _slot = JsonKeySet<N>::NOT_FOUND;
+
+            /**
+             * Moves the value just built to its slot, or to
+             * the overflow when the key is unknown
+             */
+            bool route() {
+                Json value = _builder.Take();
+
+                if (_slot == JsonKeySet<N>::NOT_FOUND)
+                    _target._overflow.try_emplace(Json::Key(_key, _resource), std::move(value));
+                else if (!_target._present[_slot]) {
+                    _target._slots[_slot] = std::move(value);
+                    _target._present.set(_slot);
+                }
+
+                return true;
+            }
+
+            /**
+             * A value at <_depth> 1 is a member of the top-level object
+             */
+            template<class Event>
+            bool value(Event event) {
+                if (_depth == 0)
+                    return false;
+                return event() && (_depth > 1 || route());
+            }
+
+            public: /**************** public members ****************/
+
+            Router(JsonSlots& target, const Json::ParseOptions& options)
+                :_target(target), _builder(options), _resource(options.resource ? options.resource : Json::heap()) { }
+
+            bool onNull() { return value([&] { return _builder.onNull(); }); }
+            bool onUndefined() { return value([&] { return _builder.onUndefined(); }); }
+            bool onInt(long long number) { return value([&] { return _builder.onInt(number); }); }
+            bool onFloat(double number) { return value([&] { return _builder.onFloat(number); }); }
+            bool onBool(bool boolean) { return value([&] { return _builder.onBool(boolean); }); }
+            bool onString(string_view text) { return value([&] { return _builder.onString(text); }); }
+            bool onSkipped(string_view text) { return value([&] { return _builder.onSkipped(text); }); }
+
+            bool onStartObject() {
+                return _depth++ == 0 || _builder.onStartObject();
+            }
+
+            bool onKey(string_view key) {
+                if (_depth > 1)
+                    return _builder.onKey(key);
+
+                _key = key;
+                _slot = _target._keys->find(key);
+                return true;
+            }
+
+            bool onEndObject(size_t count) {
+                return --_depth == 0 || (_builder.onEndObject(count) && (_depth > 1 || route()));
+            }
+
+            bool onStartArray() {
+                if (_depth == 0)
+                    return false;
+                _depth++;
+                return _builder.onStartArray();
+            }
+
+            bool onEndArray(size_t count) {
+                return --_depth == 0 || (_builder.onEndArray(count) && (_depth > 1 || route()));
+            }
+        };
+
+        public: /**************** public members ****************/
+
+        explicit JsonSlots(const JsonKeySet<N>& keys) :_keys(&keys) { }
+
+        /**
+         * Parses an object into the slots (the previous values are
+         * dropped), returns false if the <text> isn't a valid object
+         * or if anything but whitespace follows it.
+         * The <options> are the ones of Json::fromString (the members are
+         * parsed eagerly and serially, lazy and threads are ignored)
+         */
+        bool fromString(string_view text) {
+            vector<string> diagnostics;
+            return fromString(text, diagnostics);
+        }
+
+        bool fromString(string_view text, vector<string>& diagnostics, const Json::ParseOptions& options = Json::ParseOptions()) {
+            _slots = array<Json, N>();
+            _present.reset();
+            _overflow = Json::Object(options.resource ? options.resource : Json::heap());
+
+            Router router(*this, options);
+            JsonReader<Router> reader(text, router);
+
+            /**
+             * The router stops at a top-level value that isn't an object
+             */
+            if (!reader.parse()) {
+                size_t position = min(text.find_first_not_of(" \t\r\n"), text.size());
+                char current = position < text.size() ? text[position] : '\0';
+                Json::Reporter reporter;
+                reporter.ReportUnexpectedChar(current, position, '{', "An object");
+                diagnostics.push_back(reporter.Diagnostics().back());
+                return false;
+            }
+
+            reader.expectEnd();
+
+            auto& reported = reader.Diagnostics();
+            diagnostics.insert(diagnostics.end(), reported.begin(), reported.end());
+            return reported.empty();
+        }
+
+        /**
+         * Value of a slot (undefined if its key was missing)
+         */
+        Json& operator[](size_t slot) { return _slots[slot]; }
+        const Json& operator[](size_t slot) const { return _slots[slot]; }
+
+        /**
+         * Returns true if the key of the slot was in the parsed object
+         */
+        bool has(size_t slot) const { return _present[slot]; }
+
+        /**
+         * Value of any key, null if it is missing
+         */
+        Json* find(string_view key) {
+            size_t slot = _keys->find(key);
+            if (slot != JsonKeySet<N>::NOT_FOUND)
+                return has(slot) ? &_slots[slot] : nullptr;
+
+            auto member = _overflow.find(key);
+            return member == _overflow.end() ? nullptr : &member->second;
+        }
+
+        /**
+         * The members whose keys aren't in the set
+         */
+        Json::Object& overflow() { return _overflow; }
+        const Json::Object& overflow() const { return _overflow; }
+
+        const JsonKeySet<N>& keys() const { return *_keys; }
+
+        /**
+         * The object: the known keys in the order of
+         * their slots, then the overflow
+         */
+        Json toJson() const {
+            Json::Object object;
+            object.reserve(N + _overflow.size());
+
+            for (size_t slot = 0; slot < N; slot++)
+                if (has(slot))
+                    object.try_emplace((*_keys)[slot], _slots[slot]);
+            for (const auto& member : _overflow)
+                object.try_emplace(member.first, member.second);
+
+            return Json(std::move(object));
+        }
+    };
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,413 @@
+#include "JsonSnapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace JsonSer
+{
+
+    static_assert(sizeof(float) == 4 && sizeof(double) == 8, "IEEE 754 floats are expected");
+
+    /************************** Snapshot Encoder ********************************/
+
+    class JsonSnapshot::Encoder {
+
+        string& _out;
+
+        /**
+         * Offsets of the keys already written
+         */
+        unordered_map<string_view, uint64_t> _keys;
+
+        /**
+         * Appends <bytes> zeroes at an aligned
+         * offset, returns the offset
+         */
+        uint64_t allocate(const size_t& bytes) {
+            size_t offset = (_out.size() + 7) & ~(size_t)7;
+            _out.resize(offset + bytes, '\0');
+            return offset;
+        }
+
+        template<class T>
+        void put(const uint64_t& offset, const T& value) {
+            memcpy(&_out[offset], &value, sizeof(T));
+        }
+
+        uint64_t addString(const string_view& text) {
+            uint64_t offset = allocate(text.size() + 1);
+            memcpy(&_out[offset], text.data(), text.size());
+            return offset;
+        }
+
+        uint64_t addKey(const string_view& key) {
+            auto found = _keys.find(key);
+            if (found != _keys.end())
+                return found->second;
+
+            uint64_t offset = addString(key);
+            _keys.emplace(key, offset);
+            return offset;
+        }
+
+        public: /**************** public members ****************/
+
+        Encoder(string& out) :_out(out) {}
+
+        /**
+         * Writes <json> and fills the slot at <offset> with it
+         */
+        void encode(const Json& json, const uint64_t& offset) {
+            Slot slot = {};
+
+            switch (json._type) {
+                case Json::JsonType::Undefined:
+                    slot.type = Type::Undefined;
+                    break;
+                case Json::JsonType::Null:
+                    slot.type = Type::Null;
+                    break;
+                case Json::JsonType::Int:
+                    slot.type = Type::Int;
+                    slot.payload = (uint64_t)json.load<long long>();
+                    break;
+                case Json::JsonType::Float: {
+                    double value = json.load<double>();
+                    slot.type = Type::Float;
+                    memcpy(&slot.payload, &value, sizeof(value));
+                    break;
+                }
+                case Json::JsonType::Bool:
+                    slot.type = Type::Bool;
+                    slot.payload = json.load<bool>();
+                    break;
+                case Json::JsonType::String: {
+                    string_view text = json.stringView();
+                    slot.type = Type::String;
+                    slot.count = (uint32_t)text.size();
+                    slot.payload = addString(text);
+                    break;
+                }
+                case Json::JsonType::Array: {
+                    const auto& array = json.container()->_array;
+                    slot.type = Type::Array;
+                    slot.count = (uint32_t)array.size();
+                    slot.payload = allocate(array.size() * sizeof(Slot));
+
+                    for (size_t i = 0; i < array.size(); i++)
+                        encode(array[i], slot.payload + i * sizeof(Slot));
+                    break;
+                }
+                case Json::JsonType::Object: {
+                    const auto& object = json.container()->_object;
+                    size_t count = object.size();
+
+                    /**
+                     * The table is kept at most half full
+                     */
+                    uint64_t tableSize = 0;
+                    if (count > INDEXED_SIZE)
+                        for (tableSize = 1; tableSize < count * 2; tableSize <<= 1);
+
+                    slot.type = Type::Object;
+                    slot.count = (uint32_t)count;
+                    slot.payload = allocate(sizeof(uint64_t) + count * sizeof(Member) + tableSize * sizeof(uint32_t));
+                    put(slot.payload, tableSize);
+
+                    uint64_t members = slot.payload + sizeof(uint64_t);
+                    uint64_t table = members + count * sizeof(Member);
+                    size_t position = 0;
+
+                    for (const auto& kv : object) {
+                        string_view key = kv.first;
+                        uint64_t member = members + position * sizeof(Member);
+                        uint64_t hash = hashOf(key);
+
+                        put(member + offsetof(Member, hash), hash);
+                        put(member + offsetof(Member, key), (uint32_t)(addKey(key) / 8));
+                        put(member + offsetof(Member, length), (uint32_t)key.size());
+                        encode(kv.second, member + offsetof(Member, value));
+
+                        if (tableSize) {
+                            uint64_t entry = hash & (tableSize - 1);
+                            uint32_t used;
+                            while (memcpy(&used, &_out[table + entry * sizeof(uint32_t)], sizeof(used)), used)
+                                entry = (entry + 1) & (tableSize - 1);
+                            put(table + entry * sizeof(uint32_t), (uint32_t)(position + 1));
+                        }
+                        position++;
+                    }
+                    break;
+                }
+            }
+
+            put(offset, slot);
+        }
+
+        /**
+         * Pads the output to a multiple of 8
+         */
+        void finish() { allocate(0); }
+    };
+
+
+    /************************** Snapshot Value ********************************/
+
+    /**
+     * Every block starts at a multiple of 8, so
+     * a damaged offset is never read unaligned
+     */
+    const char* JsonSnapshot::Value::at(const uint64_t& offset, const uint64_t& length) const {
+        if (offset % 8 != 0 || offset > _size || length > _size - offset)
+            return nullptr;
+        return _data + offset;
+    }
+
+    /**
+     * Containers are written after their slot, so a damaged
+     * offset can't make a walk of the snapshot go round in circles
+     */
+    const char* JsonSnapshot::Value::content(const uint64_t& length) const {
+        if (_slot->payload <= (uint64_t)((const char*)_slot - _data))
+            return nullptr;
+        return at(_slot->payload, length);
+    }
+
+    JsonSnapshot::Value JsonSnapshot::Value::child(const Slot* slot) const {
+        Value value;
+        value._data = _data;
+        value._size = _size;
+        value._slot = slot;
+        return value;
+    }
+
+    const JsonSnapshot::Member* JsonSnapshot::Value::members() const {
+        if (type() != Type::Object)
+            return nullptr;
+
+        const char* block = content(sizeof(uint64_t) + (uint64_t)_slot->count * sizeof(Member));
+        return block ? (const Member*)(block + sizeof(uint64_t)) : nullptr;
+    }
+
+    double JsonSnapshot::Value::asFloat() const {
+        double value = 0;
+        if (type() == Type::Float)
+            memcpy(&value, &_slot->payload, sizeof(value));
+        return value;
+    }
+
+    string_view JsonSnapshot::Value::asString() const {
+        if (type() != Type::String)
+            return string_view();
+
+        const char* text = at(_slot->payload, _slot->count);
+        return text ? string_view(text, _slot->count) : string_view();
+    }
+
+    /**
+     * A damaged container is empty
+     */
+    size_t JsonSnapshot::Value::size() const {
+        switch (type()) {
+            case Type::Object: return members() ? _slot->count : 0;
+            case Type::Array: return content((uint64_t)_slot->count * sizeof(Slot)) ? _slot->count : 0;
+            default: return 0;
+        }
+    }
+
+    JsonSnapshot::Value JsonSnapshot::Value::operator[](size_t index) const {
+        if (type() != Type::Array || index >= _slot->count)
+            return Value();
+
+        const char* block = content((uint64_t)_slot->count * sizeof(Slot));
+        return block ? child((const Slot*)block + index) : Value();
+    }
+
+    /**
+     * Small objects are scanned, the others are looked up in their table
+     */
+    JsonSnapshot::Value JsonSnapshot::Value::operator[](string_view key) const {
+        const Member* found = members();
+        if (!found)
+            return Value();
+
+        uint64_t hash = hashOf(key);
+        size_t count = _slot->count;
+
+        auto matches = [&](const Member& member) {
+            if (member.hash != hash || member.length != key.size())
+                return false;
+            const char* text = at((uint64_t)member.key * 8, member.length);
+            return text && memcmp(text, key.data(), key.size()) == 0;
+        };
+
+        uint64_t tableSize;
+        memcpy(&tableSize, (const char*)found - sizeof(uint64_t), sizeof(tableSize));
+
+        if (tableSize == 0) {
+            for (size_t i = 0; i < count; i++)
+                if (matches(found[i])) return child(&found[i].value);
+            return Value();
+        }
+
+        if (tableSize > _size / sizeof(uint32_t) || (tableSize & (tableSize - 1)))
+            return Value();
+
+        const uint32_t* table = (const uint32_t*)at(_slot->payload + sizeof(uint64_t) + count * sizeof(Member), tableSize * sizeof(uint32_t));
+        if (!table)
+            return Value();
+
+        /**
+         * At most <tableSize> probes, even in a damaged table
+         */
+        uint64_t entry = hash & (tableSize - 1);
+        for (uint64_t probes = 0; probes < tableSize && table[entry]; probes++) {
+            uint32_t position = table[entry] - 1;
+            if (position < count && matches(found[position]))
+                return child(&found[position].value);
+            entry = (entry + 1) & (tableSize - 1);
+        }
+        return Value();
+    }
+
+    string_view JsonSnapshot::Value::key(size_t position) const {
+        const Member* found = members();
+        if (!found || position >= _slot->count)
+            return string_view();
+
+        const char* text = at((uint64_t)found[position].key * 8, found[position].length);
+        return text ? string_view(text, found[position].length) : string_view();
+    }
+
+    JsonSnapshot::Value JsonSnapshot::Value::value(size_t position) const {
+        const Member* found = members();
+        if (!found || position >= _slot->count)
+            return Value();
+        return child(&found[position].value);
+    }
+
+    Json JsonSnapshot::Value::toJson() const {
+        switch (type()) {
+            case Type::Undefined: return Json();
+            case Type::Null: return Json(nullptr);
+            case Type::Int: return Json(asInt());
+            case Type::Float: return Json(asFloat());
+            case Type::Bool: return Json(asBool());
+            case Type::String: return Json(string(asString()));
+            case Type::Array: {
+                Json::Array array(Json::heap());
+                array.reserve(size());
+                for (size_t i = 0; i < size(); i++)
+                    array.push_back((*this)[i].toJson());
+                return Json(std::move(array));
+            }
+            case Type::Object: {
+                Json::Object object;
+                object.reserve(size());
+                for (size_t i = 0; i < size(); i++)
+                    object.try_emplace(key(i), value(i).toJson());
+                return Json(std::move(object));
+            }
+        }
+        return Json();
+    }
+
+
+    /************************** Json Snapshot ********************************/
+
+    JsonSnapshot::JsonSnapshot(const string& path)
+        :_file(new MappedFile(path))
+    {
+        if (!_file->isOpen()) {
+            _reporter.ReportUnreadableFile(path);
+            return;
+        }
+
+        _data = _file->view();
+        open();
+    }
+
+    JsonSnapshot::JsonSnapshot(string_view data)
+        :_data(data)
+    {
+        open();
+    }
+
+    void JsonSnapshot::open() {
+        static const char magic[] = "JSNP";
+
+        if (_data.size() < sizeof(Header))
+            return _reporter.ReportUnexpectedEnd(_data.size(), "Header of a snapshot");
+
+        for (size_t i = 0; i < 4; i++)
+            if (_data[i] != magic[i])
+                return _reporter.ReportUnexpectedByte((uint8_t)_data[i], i, "Magic of a snapshot");
+
+        if ((uintptr_t)_data.data() % 8 != 0)
+            return _reporter.ReportUnexpectedByte((uint8_t)_data[0], 0, "Snapshot aligned to 8 bytes");
+
+        const Header& header = *(const Header*)_data.data();
+
+        /**
+         * A snapshot of another byte order has a swapped version
+         */
+        if (header.version != VERSION)
+            return _reporter.ReportUnexpectedByte((uint8_t)_data[offsetof(Header, version)], offsetof(Header, version), "Version of a snapshot");
+
+        if (header.size > _data.size())
+            return _reporter.ReportUnexpectedEnd(_data.size(), "Snapshot of " + to_string(header.size) + " bytes");
+
+        _data = _data.substr(0, header.size);
+        _valid = true;
+    }
+
+    JsonSnapshot::Value JsonSnapshot::root() const {
+        Value value;
+        if (!_valid)
+            return value;
+
+        value._data = _data.data();
+        value._size = _data.size();
+        value._slot = &((const Header*)_data.data())->root;
+        return value;
+    }
+
+    string JsonSnapshot::encode(const Json& json) {
+        string out(sizeof(Header), '\0');
+
+        Encoder encoder(out);
+        encoder.encode(json, offsetof(Header, root));
+        encoder.finish();
+
+        Header header;
+        memcpy(&header, out.data(), sizeof(header));
+        memcpy(header.magic, "JSNP", 4);
+        header.version = VERSION;
+        header.size = out.size();
+        memcpy(&out[0], &header, sizeof(header));
+
+        return out;
+    }
+
+    bool JsonSnapshot::save(const Json& json, const string& path) {
+        string bytes = encode(json);
+
+        ofstream file(path, ios::binary | ios::trunc);
+        file.write(bytes.data(), bytes.size());
+        return (bool)file;
+    }
+
+    /**
+     * FNV-1a
+     */
+    uint64_t JsonSnapshot::hashOf(string_view text) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const char& c : text) {
+            hash ^= (uint8_t)c;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+} // namespace JsonSer
@@ -0,0 +1,224 @@
+#ifndef JSON_SNAPSHOT_API
+#define JSON_SNAPSHOT_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+#include "MappedFile.h"
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A read only Json in a binary format that is used in place
+     *
+     * The format is position independent (offsets from the start instead
+     * of pointers) with 8 byte aligned scalars, so a snapshot file can be
+     * mapped and queried right away: opening it only checks the header,
+     * values are views of the bytes, lookups don't allocate.
+     * Objects bigger than INDEXED_SIZE carry a precomputed hash table of
+     * their keys, arrays are indexed directly.
+     * Numbers are stored little endian, a snapshot written on another
+     * byte order is rejected
+     *
+     * Layout (offsets in bytes, all of them multiple of 8):
+     * - header: magic "JSNP", version, total size, root slot
+     * - slot (16): type, count or length, payload (a number or an offset)
+     * - string: its bytes and a '\0'
+     * - array: <count> slots
+     * - object: table size, <count> members (hash, key offset / 8, key
+     *   length, slot) in insertion order, then the table of member
+     *   positions + 1 (0 is an empty entry), keys are stored once
+     */
+    class JsonSnapshot {
+
+        public: /**************** public members ****************/
+
+        enum class Type : uint8_t
+        {
+            Undefined,
+            Null,
+            Int,
+            Float,
+            Bool,
+            String,
+            Object,
+            Array
+        };
+
+        static const uint32_t VERSION = 1;
+
+        /**
+         * Smallest object with a table of keys
+         */
+        static const size_t INDEXED_SIZE = 16;
+
+        private: /**************** private members ****************/
+
+        struct Slot
+        {
+            Type type;
+            uint8_t reserved[3];
+            uint32_t count;
+            uint64_t payload;
+        };
+
+        struct Member
+        {
+            uint64_t hash;
+            uint32_t key;
+            uint32_t length;
+            Slot value;
+        };
+
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint64_t size;
+            Slot root;
+        };
+
+        /**
+         * Bytes of the snapshot: a mapped file or the caller's memory
+         */
+        unique_ptr<MappedFile> _file;
+        string_view _data;
+
+        Json::Reporter _reporter;
+        bool _valid = false;
+
+        /**
+         * Checks the header of <_data>
+         */
+        void open();
+
+        /**
+         * Builds the snapshot of a tree
+         */
+        class Encoder;
+
+        public: /**************** public members ****************/
+
+        /**
+         * A value of a snapshot, it's only valid while the snapshot is
+         * open. A missing member, an index out of range or a damaged
+         * offset is an undefined value
+         */
+        class Value {
+
+            const char* _data = nullptr;
+            size_t _size = 0;
+            const Slot* _slot = nullptr;
+
+            /**
+             * <length> bytes at <offset>, nullptr if they
+             * aren't all inside the snapshot
+             */
+            const char* at(const uint64_t& offset, const uint64_t& length) const;
+
+            /**
+             * <length> bytes of the content of a container
+             */
+            const char* content(const uint64_t& length) const;
+
+            Value child(const Slot*) const;
+
+            const Member* members() const;
+
+            friend class JsonSnapshot;
+
+            public: /**************** public members ****************/
+
+            Value() {}
+
+            Type type() const { return _slot ? _slot->type : Type::Undefined; }
+
+            bool isUndefined() const { return type() == Type::Undefined; }
+            bool isNull() const { return type() == Type::Null; }
+
+            /**
+             * Scalars, a value of another type gives the default
+             */
+            long long asInt() const { return type() == Type::Int ? (long long)_slot->payload : 0; }
+            double asFloat() const;
+            bool asBool() const { return type() == Type::Bool && _slot->payload; }
+            string_view asString() const;
+
+            /**
+             * Number of members or elements
+             */
+            size_t size() const;
+
+            /**
+             * Element of an array
+             */
+            Value operator[](size_t) const;
+
+            /**
+             * Member of an object
+             */
+            Value operator[](string_view) const;
+
+            /**
+             * Key and value of the member at <position> of an object
+             */
+            string_view key(size_t position) const;
+            Value value(size_t position) const;
+
+            /**
+             * A Json copy of the value
+             */
+            Json toJson() const;
+        };
+
+        /**
+         * Maps the snapshot file at <path>
+         */
+        JsonSnapshot(const string& path);
+        JsonSnapshot(const char* path) :JsonSnapshot(string(path)) {}
+
+        /**
+         * A snapshot in memory owned by the caller,
+         * <data> must be aligned to 8 bytes
+         */
+        JsonSnapshot(string_view data);
+
+        JsonSnapshot(const JsonSnapshot&) = delete;
+        JsonSnapshot& operator=(const JsonSnapshot&) = delete;
+
+        /**
+         * Returns false if the snapshot couldn't be opened
+         * (its root is then undefined)
+         */
+        bool isValid() const { return _valid; }
+
+        Value root() const;
+
+        /**
+         * Bytes of the snapshot of <json>
+         */
+        static string encode(const Json&);
+
+        /**
+         * Writes the snapshot of <json> to the file
+         * at <path>, returns false if it couldn't
+         */
+        static bool save(const Json&, const string& path);
+
+        /**
+         * Hash of the keys, the same on every platform
+         */
+        static uint64_t hashOf(string_view);
+
+        /**
+         * Diagnostic property
+         */
+        vector<string>& Diagnostics() { return _reporter.Diagnostics(); }
+    };
+
+} // namespace JsonSer
+
+#endif
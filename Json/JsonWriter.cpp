@@ -0,0 +1,381 @@
+#include "JsonWriter.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/uio.h>
+#include <climits>
+#endif
+
+namespace JsonSer
+{
+
+    /**
+     * Number formatting into a stack buffer
+     */
+    static inline size_t formatInt(char* buffer, const long long& value) {
+        return to_chars(buffer, buffer + 32, value).ptr - buffer;
+    }
+    /**
+     * The shortest text that reads back as the same double,
+     * it always looks like a float (1 is written as 1.0)
+     * and json has no representation for nan and infinity
+     */
+    static inline size_t formatFloat(char* buffer, const double& value) {
+        if (!isfinite(value)) {
+            memcpy(buffer, "null", 4);
+            return 4;
+        }
+
+        char* end = to_chars(buffer, buffer + 32, value).ptr;
+
+        if (find_if(buffer, end, [](char c) { return c == '.' || c == 'e'; }) == end) {
+            *end++ = '.';
+            *end++ = '0';
+        }
+        return end - buffer;
+    }
+
+
+    /************************** Json Writer **************************/
+
+    JsonWriter::JsonWriter(string& out)
+        :_out(&out) { }
+
+    JsonWriter::JsonWriter(ostream& stream)
+        :_stream(&stream) 
+    {
+        _buffer.reserve(FLUSH_SIZE);
+    }
+
+    JsonWriter::JsonWriter(int fd)
+        :_fd(fd) 
+    {
+        _buffer.reserve(FLUSH_SIZE);
+    }
+
+    JsonWriter::~JsonWriter() {
+        flush();
+    }
+
+    void JsonWriter::separate() {
+        if (_needComma)
+            target().push_back(',');
+        _needComma = true;
+    }
+
+    void JsonWriter::flushIfFull() {
+        if (!_out && _buffer.size() >= FLUSH_SIZE)
+            flush();
+    }
+
+    /**
+     * Sends the staging buffer
+     */
+    void JsonWriter::flush() {
+        if (_out || _buffer.empty())
+            return;
+
+        if (_stream)
+            _stream->write(_buffer.data(), _buffer.size());
+
+        else if (_fd >= 0) {
+            const char* data = _buffer.data();
+            size_t left = _buffer.size();
+
+            while (left > 0) {
+#ifdef _WIN32
+                int written = _write(_fd, data, (unsigned int)left);
+#else
+                ssize_t written = ::write(_fd, data, left);
+#endif
+                if (written <= 0)
+                    break;
+                data += written;
+                left -= written;
+            }
+        }
+
+        _buffer.clear();
+    }
+
+    /**
+     * Writes a value piece by piece
+     */
+    void JsonWriter::writeNull() {
+        separate();
+        target().append("null", 4);
+    }
+
+    void JsonWriter::writeUndefined() {
+        separate();
+        target().append("undefined", 9);
+    }
+
+    void JsonWriter::writeInt(long long value) {
+        char buffer[32];
+        separate();
+        target().append(buffer, formatInt(buffer, value));
+    }
+
+    void JsonWriter::writeUnsigned(unsigned long long value) {
+        char buffer[32];
+        separate();
+        target().append(buffer, to_chars(buffer, buffer + 32, value).ptr - buffer);
+    }
+
+    void JsonWriter::writeFloat(double value) {
+        char buffer[40];
+        separate();
+        target().append(buffer, formatFloat(buffer, value));
+    }
+
+    void JsonWriter::writeBool(bool value) {
+        separate();
+        if (value) target().append("true", 4);
+        else target().append("false", 5);
+    }
+
+    void JsonWriter::writeString(string_view value) {
+        separate();
+        string& out = target();
+        out.push_back('"');
+        out.append(value);
+        out.push_back('"');
+        flushIfFull();
+    }
+
+    void JsonWriter::startObject() {
+        separate();
+        target().push_back('{');
+        _needComma = false;
+    }
+
+    void JsonWriter::key(string_view key) {
+        separate();
+        string& out = target();
+        out.push_back('"');
+        out.append(key);
+        out.append("\":", 2);
+        _needComma = false;
+    }
+
+    void JsonWriter::endObject() {
+        target().push_back('}');
+        _needComma = true;
+        flushIfFull();
+    }
+
+    void JsonWriter::startArray() {
+        separate();
+        target().push_back('[');
+        _needComma = false;
+    }
+
+    void JsonWriter::endArray() {
+        target().push_back(']');
+        _needComma = true;
+        flushIfFull();
+    }
+
+    /**
+     * Writes a whole value
+     */
+    void JsonWriter::write(const Json& json) {
+        switch (json._type) {
+            case Json::JsonType::Undefined: return writeUndefined();
+            case Json::JsonType::Null: return writeNull();
+            case Json::JsonType::Int: return writeInt(json.load<long long>());
+            case Json::JsonType::Float: return writeFloat(json.load<double>());
+            case Json::JsonType::Bool: return writeBool(json.load<bool>());
+            case Json::JsonType::String: return writeString(json.stringView());
+            case Json::JsonType::Object:
+                startObject();
+                for (const auto& kv : json.container()->_object) {
+                    key(kv.first);
+                    write(kv.second);
+                }
+                return endObject();
+            case Json::JsonType::Array:
+                startArray();
+                for (const auto& e : json.container()->_array)
+                    write(e);
+                return endArray();
+        }
+    }
+
+    /**
+     * Parallel writing, the pool is selected once for the whole value
+     */
+    void JsonWriter::writeParallel(const Json& json, size_t threads) {
+        if (ThreadPool::workers(threads) < 2)
+            return write(json);
+        writeParallel(json, ThreadPool::of(threads));
+    }
+
+    void JsonWriter::writeParallel(const Json& json, ThreadPool& pool) {
+        bool isObject = json._type == Json::JsonType::Object;
+
+        if (pool.size() < 2 || (!isObject && json._type != Json::JsonType::Array))
+            return write(json);
+
+        Json::Impl& container = *json.container();
+        size_t count = isObject ? container._object.size() : container._array.size();
+
+        /**
+         * A small container is written here, its children can be big
+         */
+        if (count < PARALLEL_CHILDREN) {
+            if (isObject) {
+                startObject();
+                for (const auto& kv : container._object) {
+                    key(kv.first);
+                    writeParallel(kv.second, pool);
+                }
+                return endObject();
+            }
+
+            startArray();
+            for (const auto& e : container._array)
+                writeParallel(e, pool);
+            return endArray();
+        }
+
+        /**
+         * A few chunks per worker so that they can be stolen,
+         * each chunk starts with the comma that separates it
+         * from the previous one
+         */
+        size_t chunkSize = count / (pool.size() * 8) + 1;
+        if (chunkSize < CHUNK_CHILDREN)
+            chunkSize = CHUNK_CHILDREN;
+        vector<string> chunks((count + chunkSize - 1) / chunkSize);
+
+        pool.parallelFor(chunks.size(), [&](size_t chunk) {
+            JsonWriter writer(chunks[chunk]);
+            writer._needComma = chunk > 0;
+
+            size_t end = min(count, (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; i++) {
+                if (isObject) {
+                    const auto& member = *(container._object.begin() + i);
+                    writer.key(member.first);
+                    writer.write(member.second);
+                }
+                else
+                    writer.write(container._array[i]);
+            }
+        });
+
+        if (isObject) startObject();
+        else startArray();
+
+        writeChunks(chunks);
+
+        if (isObject) endObject();
+        else endArray();
+    }
+
+    void JsonWriter::writeChunks(const vector<string>& chunks) {
+        if (_out) {
+            size_t size = _out->size();
+            for (const auto& chunk : chunks)
+                size += chunk.size();
+            _out->reserve(size + 1);
+
+            for (const auto& chunk : chunks)
+                _out->append(chunk);
+            return;
+        }
+
+        flush();
+
+        if (_stream) {
+            for (const auto& chunk : chunks)
+                _stream->write(chunk.data(), chunk.size());
+            return;
+        }
+
+        if (_fd < 0)
+            return;
+
+#ifdef _WIN32
+        for (const auto& chunk : chunks) {
+            const char* data = chunk.data();
+            size_t left = chunk.size();
+
+            while (left > 0) {
+                int written = _write(_fd, data, (unsigned int)left);
+                if (written <= 0)
+                    return;
+                data += written;
+                left -= written;
+            }
+        }
+#else
+        /**
+         * Scatter/gather: one system call for up to IOV_MAX chunks,
+         * a partial write resumes in the middle of a chunk
+         */
+        vector<iovec> vectors;
+        for (const auto& chunk : chunks)
+            if (!chunk.empty())
+                vectors.push_back({ (void*)chunk.data(), chunk.size() });
+
+        size_t first = 0;
+        while (first < vectors.size()) {
+            int count = (int)min(vectors.size() - first, (size_t)IOV_MAX);
+            ssize_t written = ::writev(_fd, vectors.data() + first, count);
+            if (written <= 0)
+                return;
+
+            while (first < vectors.size() && (size_t)written >= vectors[first].iov_len)
+                written -= vectors[first++].iov_len;
+
+            if (written > 0) {
+                vectors[first].iov_base = (char*)vectors[first].iov_base + written;
+                vectors[first].iov_len -= written;
+            }
+        }
+#endif
+    }
+
+    /**
+     * Size pre-pass
+     */
+    size_t JsonWriter::measure(const Json& json) {
+        char buffer[40];
+
+        switch (json._type) {
+            case Json::JsonType::Undefined: return 9;
+            case Json::JsonType::Null: return 4;
+            case Json::JsonType::Int: return formatInt(buffer, json.load<long long>());
+            case Json::JsonType::Float: return formatFloat(buffer, json.load<double>());
+            case Json::JsonType::Bool: return json.load<bool>() ? 4 : 5;
+            case Json::JsonType::String: return json.stringView().size() + 2;
+            case Json::JsonType::Object: {
+                const auto& object = json.container()->_object;
+                size_t size = 2;
+                for (const auto& kv : object)
+                    size += kv.first.size() + 4 + measure(kv.second);
+                return size - (object.empty() ? 0 : 1);
+            }
+            case Json::JsonType::Array: {
+                const auto& array = json.container()->_array;
+                size_t size = 2;
+                for (const auto& e : array)
+                    size += measure(e) + 1;
+                return size - (array.empty() ? 0 : 1);
+            }
+        }
+        return 0;
+    }
+
+} // namespace JsonSer
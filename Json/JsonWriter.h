@@ -0,0 +1,147 @@
+#ifndef JSON_WRITER_API
+#define JSON_WRITER_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+
+#include <ostream>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    class ThreadPool;
+
+    /**
+     * A streaming serializer
+     *
+     * Everything is appended to a single growable buffer: the target
+     * string itself, or a staging buffer that is flushed to an
+     * ostream or a file descriptor when it gets full.
+     * Values can be written as a whole (write) or piece by piece
+     * (startObject, key, writeInt, ..., endObject), commas are 
+     * placed by the writer
+     */
+    class JsonWriter {
+
+        /**
+         * Sinks, only one of them is used
+         */
+        string* _out = nullptr;
+        ostream* _stream = nullptr;
+        int _fd = -1;
+
+        /**
+         * Staging buffer for streams and file descriptors
+         */
+        string _buffer;
+
+        /**
+         * True when the next value needs a comma before it
+         */
+        bool _needComma = false;
+
+        static const size_t FLUSH_SIZE = 64 * 1024;
+
+        /**
+         * Smallest container written in parallel and
+         * smallest number of children in a chunk
+         */
+        static const size_t PARALLEL_CHILDREN = 1024;
+        static const size_t CHUNK_CHILDREN = 64;
+
+        /**
+         * The buffer the writer appends to
+         */
+        string& target() { return _out ? *_out : _buffer; }
+
+        /**
+         * Puts a comma before a value if needed
+         */
+        void separate();
+
+        /**
+         * Flushes the staging buffer once it's full
+         */
+        void flushIfFull();
+
+        /**
+         * A value whose big containers are written in parallel on <pool>
+         */
+        void writeParallel(const Json&, ThreadPool& pool);
+
+        /**
+         * Sends buffers written by other writers after the
+         * staging buffer (gathered in a single call for files)
+         */
+        void writeChunks(const vector<string>&);
+
+        public: /**************** public members ****************/
+
+        /**
+         * Appends to <out>
+         */
+        JsonWriter(string&);
+
+        /**
+         * Writes to a stream
+         */
+        JsonWriter(ostream&);
+
+        /**
+         * Writes to a file descriptor
+         */
+        JsonWriter(int);
+
+        ~JsonWriter();
+
+        JsonWriter(const JsonWriter&) = delete;
+        JsonWriter& operator=(const JsonWriter&) = delete;
+
+        /**
+         * Writes a whole value
+         */
+        void write(const Json&);
+
+        /**
+         * Writes a whole value, containers of PARALLEL_CHILDREN or more
+         * children are split in chunks written concurrently into their
+         * own buffers (<threads> as in Json::ParseOptions). The output
+         * is the same as the one of write()
+         */
+        void writeParallel(const Json&, size_t threads = 0);
+
+        /**
+         * Writes a value piece by piece
+         */
+        void writeNull();
+        void writeUndefined();
+        void writeInt(long long);
+        void writeUnsigned(unsigned long long);
+        void writeFloat(double);
+        void writeBool(bool);
+        void writeString(string_view);
+        void startObject();
+        void key(string_view);
+        void endObject();
+        void startArray();
+        void endArray();
+
+        /**
+         * Sends the staging buffer to the stream
+         * or to the file descriptor
+         */
+        void flush();
+
+        /**
+         * Size pre-pass: the exact number of 
+         * chars write() produces for a value
+         */
+        static size_t measure(const Json&);
+    };
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,96 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace JsonSer
+{
+
+    /************************** Mapped File **************************/
+
+#ifdef _WIN32
+
+    MappedFile::MappedFile(const string& path) {
+        HANDLE file = CreateFileA(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL
+        );
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+
+        _file = file;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+            return;
+
+        _size = (size_t)size.QuadPart;
+
+        /**
+         * An empty file can't be mapped
+         */
+        if (_size == 0) {
+            _open = true;
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL)
+            return;
+
+        _mapping = mapping;
+        _data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        _open = _data != nullptr;
+    }
+
+    MappedFile::~MappedFile() {
+        if (_data) UnmapViewOfFile(_data);
+        if (_mapping) CloseHandle((HANDLE)_mapping);
+        if (_file) CloseHandle((HANDLE)_file);
+    }
+
+#else
+
+    MappedFile::MappedFile(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            _size = (size_t)info.st_size;
+
+            /**
+             * An empty file can't be mapped
+             */
+            if (_size == 0)
+                _open = true;
+            else {
+                void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    madvise(data, _size, MADV_SEQUENTIAL);
+                    _data = (const char*)data;
+                    _open = true;
+                }
+            }
+        }
+
+        /**
+         * The mapping stays valid after closing the descriptor
+         */
+        close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (_data) munmap((void*)_data, _size);
+    }
+
+#endif
+
+} // namespace JsonSer
@@ -0,0 +1,54 @@
+#ifndef MAPPED_FILE_API
+#define MAPPED_FILE_API
+
+/**
+ * Libraries
+ */
+#include <string>
+#include <string_view>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A read only view of a file mapped in memory
+     */
+    class MappedFile {
+
+        const char* _data = nullptr;
+        size_t _size = 0;
+        bool _open = false;
+
+        /**
+         * Native handles (only used on windows)
+         */
+        void* _file = nullptr;
+        void* _mapping = nullptr;
+
+        public: /**************** public members ****************/
+
+        /**
+         * Maps the whole file at <path>
+         */
+        MappedFile(const string&);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * Returns true if the file has been mapped
+         */
+        bool isOpen() const { return _open; }
+
+        /**
+         * The content of the file
+         */
+        string_view view() const { return string_view(_data, _size); }
+    };
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,63 @@
+#include "ParseStats.h"
+
+namespace JsonSer
+{
+
+    /************************** Parse Stats **************************/
+
+    void ParseStats::countValue(const Json::JsonType& type) {
+        switch (type) {
+            case Json::JsonType::Null: nulls++; break;
+            case Json::JsonType::Undefined: undefineds++; break;
+            case Json::JsonType::Int: ints++; break;
+            case Json::JsonType::Float: floats++; break;
+            case Json::JsonType::Bool: bools++; break;
+            case Json::JsonType::String: break;
+            case Json::JsonType::Object: objects++; break;
+            case Json::JsonType::Array: arrays++; break;
+        }
+    }
+
+    ParseStats& ParseStats::operator+=(const ParseStats& other) {
+        bytes += other.bytes;
+        nulls += other.nulls;
+        undefineds += other.undefineds;
+        ints += other.ints;
+        floats += other.floats;
+        bools += other.bools;
+        strings += other.strings;
+        objects += other.objects;
+        arrays += other.arrays;
+        keys += other.keys;
+        heapStrings += other.heapStrings;
+        reachDepth(other.maxDepth);
+        diagnostics += other.diagnostics;
+        scanNanoseconds += other.scanNanoseconds;
+        numberNanoseconds += other.numberNanoseconds;
+        buildNanoseconds += other.buildNanoseconds;
+        return *this;
+    }
+
+    Json ParseStats::toJson() const {
+        Json::Object stats;
+        stats.reserve(16);
+        stats.try_emplace("bytes", Json((long long)bytes));
+        stats.try_emplace("nulls", Json((long long)nulls));
+        stats.try_emplace("undefineds", Json((long long)undefineds));
+        stats.try_emplace("ints", Json((long long)ints));
+        stats.try_emplace("floats", Json((long long)floats));
+        stats.try_emplace("bools", Json((long long)bools));
+        stats.try_emplace("strings", Json((long long)strings));
+        stats.try_emplace("objects", Json((long long)objects));
+        stats.try_emplace("arrays", Json((long long)arrays));
+        stats.try_emplace("keys", Json((long long)keys));
+        stats.try_emplace("heap_strings", Json((long long)heapStrings));
+        stats.try_emplace("max_depth", Json((long long)maxDepth));
+        stats.try_emplace("diagnostics", Json((long long)diagnostics));
+        stats.try_emplace("scan_ns", Json(scanNanoseconds));
+        stats.try_emplace("number_ns", Json(numberNanoseconds));
+        stats.try_emplace("build_ns", Json(buildNanoseconds));
+        return Json(std::move(stats));
+    }
+
+} // namespace JsonSer
@@ -0,0 +1,129 @@
+#ifndef PARSE_STATS_API
+#define PARSE_STATS_API
+
+/**
+ * Libraries
+ */
+#include "Json.h"
+
+#include <chrono>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * Statistics of a JsonReader<Handler, Stats>
+     *
+     * The reader calls the hooks of its <Stats> while it parses.
+     * NoParseStats is the default: its hooks are empty and inlined
+     * away, so a reader without statistics is the same code as before.
+     * ParseStats counts and times what the reader does:
+     *
+     *     ParseStats stats;
+     *     Json::ParseOptions options;
+     *     options.stats = &stats;
+     *     Json json = Json::fromString(text, options);
+     *     cout << stats.toJson();
+     */
+    struct NoParseStats
+    {
+        /**
+         * Start of a timed phase
+         */
+        struct Stamp { };
+
+        Stamp start() const { return Stamp(); }
+        void scanned(const Stamp&) { }
+        void converted(const Stamp&) { }
+        void built(const Stamp&) { }
+
+        void countValue(const Json::JsonType&) { }
+        void countKey(const size_t&) { }
+        void countString(const size_t&) { }
+        void reachDepth(const size_t&) { }
+        void finish(const size_t&, const size_t&) { }
+
+        NoParseStats& operator+=(const NoParseStats&) { return *this; }
+    };
+
+    /**
+     * Counters and phase times of one or more parsings, they are added
+     * up by +=. Every number and container event reads the clock twice,
+     * which costs more than converting a short number: an input made of
+     * numbers parses a few times slower with statistics
+     */
+    struct ParseStats
+    {
+        using Stamp = chrono::steady_clock::time_point;
+
+        /**
+         * Bytes of input parsed
+         */
+        size_t bytes = 0;
+
+        /**
+         * Values by type (containers skipped
+         * by a lazy parsing are counted too)
+         */
+        size_t nulls = 0;
+        size_t undefineds = 0;
+        size_t ints = 0;
+        size_t floats = 0;
+        size_t bools = 0;
+        size_t strings = 0;
+        size_t objects = 0;
+        size_t arrays = 0;
+
+        size_t keys = 0;
+
+        /**
+         * String values too long to be stored inside
+         * a Json, each one is allocated unless interned
+         */
+        size_t heapStrings = 0;
+
+        size_t maxDepth = 0;
+        size_t diagnostics = 0;
+
+        /**
+         * Nanoseconds spent building the structural index, converting
+         * numbers and in the container events of the handler
+         * (building the objects and arrays of a tree)
+         */
+        long long scanNanoseconds = 0;
+        long long numberNanoseconds = 0;
+        long long buildNanoseconds = 0;
+
+        /**
+         * Hooks of the reader
+         */
+        Stamp start() const { return chrono::steady_clock::now(); }
+        void scanned(const Stamp& stamp) { scanNanoseconds += elapsed(stamp); }
+        void converted(const Stamp& stamp) { numberNanoseconds += elapsed(stamp); }
+        void built(const Stamp& stamp) { buildNanoseconds += elapsed(stamp); }
+
+        void countValue(const Json::JsonType&);
+        void countKey(const size_t&) { keys++; }
+        void countString(const size_t& length) { strings++; heapStrings += length > Json::SHORT_STRING; }
+        void reachDepth(const size_t& depth) { if (depth > maxDepth) maxDepth = depth; }
+        void finish(const size_t& position, const size_t& reported) { bytes = position; diagnostics = reported; }
+
+        ParseStats& operator+=(const ParseStats&);
+
+        /**
+         * The counters in a flat object, the names of
+         * the fields in snake case ("max_depth", "scan_ns", ...)
+         */
+        Json toJson() const;
+
+        private: /**************** private members ****************/
+
+        static long long elapsed(const Stamp& stamp) {
+            return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - stamp).count();
+        }
+    };
+
+} // namespace JsonSer
+
+#endif
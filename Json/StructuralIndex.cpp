@@ -0,0 +1,316 @@
+#include "StructuralIndex.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define STRUCTURAL_INDEX_X86
+#include <immintrin.h>
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STRUCTURAL_INDEX_TARGET(x) __attribute__((target(x)))
+#else
+#define STRUCTURAL_INDEX_TARGET(x)
+#endif
+
+namespace JsonSer
+{
+
+    /**
+     * Bit masks of a 64 bytes block, bit <i> is set
+     * when the char at <i> belongs to the class
+     */
+    struct BlockMasks
+    {
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t whitespace;
+        uint64_t op;
+    };
+
+    typedef void (*Classifier)(const char*, BlockMasks&);
+
+    /**
+     * Bit helpers
+     */
+    static inline int trailingZeros(const uint64_t& bits) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return (int)index;
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+
+    static inline int popCount(uint64_t bits) {
+#ifdef _MSC_VER
+        int count = 0;
+        while (bits) { bits &= bits - 1; count++; }
+        return count;
+#else
+        return __builtin_popcountll(bits);
+#endif
+    }
+
+    /**
+     * Bit <i> of the result is the xor of the bits [0, i],
+     * a quote mask becomes the mask of the inside of the strings
+     */
+    static inline uint64_t prefixXor(uint64_t bits) {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+    /**
+     * Mask of the chars preceded by an odd number of backslashes,
+     * <carry> is set when the first char of the next block is escaped
+     */
+    static inline uint64_t escapedChars(uint64_t backslash, uint64_t& carry) {
+        uint64_t escaped = carry;
+        carry = 0;
+
+        while (backslash) {
+            int i = trailingZeros(backslash);
+            backslash &= backslash - 1;
+
+            if ((escaped >> i) & 1)
+                continue;
+
+            if (i == 63) carry = 1;
+            else escaped |= uint64_t(1) << (i + 1);
+        }
+        return escaped;
+    }
+
+
+    /************************** Classifiers **************************/
+
+    static const uint8_t CLASS_QUOTE = 1;
+    static const uint8_t CLASS_BACKSLASH = 2;
+    static const uint8_t CLASS_WHITESPACE = 4;
+    static const uint8_t CLASS_OP = 8;
+
+    struct ClassTable
+    {
+        uint8_t _classes[256] = {};
+
+        ClassTable() {
+            _classes[(uint8_t)'"'] = CLASS_QUOTE;
+            _classes[(uint8_t)'\\'] = CLASS_BACKSLASH;
+            for (char c : string_view(" \t\r\n")) _classes[(uint8_t)c] = CLASS_WHITESPACE;
+            for (char c : string_view("{}[]:,")) _classes[(uint8_t)c] = CLASS_OP;
+        }
+    };
+
+    static const ClassTable classTable;
+
+    static void classifyScalar(const char* block, BlockMasks& masks) {
+        masks = BlockMasks{ 0, 0, 0, 0 };
+        for (int i = 0; i < 64; i++) {
+            uint8_t c = classTable._classes[(uint8_t)block[i]];
+            uint64_t bit = uint64_t(1) << i;
+            if (c & CLASS_QUOTE) masks.quote |= bit;
+            if (c & CLASS_BACKSLASH) masks.backslash |= bit;
+            if (c & CLASS_WHITESPACE) masks.whitespace |= bit;
+            if (c & CLASS_OP) masks.op |= bit;
+        }
+    }
+
+#ifdef STRUCTURAL_INDEX_X86
+
+    /**
+     * SSE4.2: the string compare instruction matches
+     * every char of a chunk against a set of chars
+     */
+    STRUCTURAL_INDEX_TARGET("sse4.2")
+    static void classifySSE42(const char* block, BlockMasks& masks) {
+        const int mode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+        const __m128i whitespaces = _mm_setr_epi8(' ', '\t', '\r', '\n', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i ops = _mm_setr_epi8('{', '}', '[', ']', ':', ',', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+
+        masks = BlockMasks{ 0, 0, 0, 0 };
+        for (int i = 0; i < 4; i++) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(block + 16 * i));
+            int shift = 16 * i;
+
+            masks.quote |= uint64_t((uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote))) << shift;
+            masks.backslash |= uint64_t((uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash))) << shift;
+            masks.whitespace |= uint64_t((uint16_t)_mm_cvtsi128_si32(_mm_cmpestrm(whitespaces, 4, chunk, 16, mode))) << shift;
+            masks.op |= uint64_t((uint16_t)_mm_cvtsi128_si32(_mm_cmpestrm(ops, 6, chunk, 16, mode))) << shift;
+        }
+    }
+
+    /**
+     * AVX2: 32 chars per compare, '[' and '{' (and ']' and '}')
+     * only differ by 0x20 so they share a compare
+     */
+    STRUCTURAL_INDEX_TARGET("avx2")
+    static void classifyAVX2(const char* block, BlockMasks& masks) {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i carriage = _mm256_set1_epi8('\r');
+        const __m256i newline = _mm256_set1_epi8('\n');
+        const __m256i lowercase = _mm256_set1_epi8(0x20);
+        const __m256i open = _mm256_set1_epi8('{');
+        const __m256i close = _mm256_set1_epi8('}');
+        const __m256i colon = _mm256_set1_epi8(':');
+        const __m256i comma = _mm256_set1_epi8(',');
+
+        masks = BlockMasks{ 0, 0, 0, 0 };
+        for (int i = 0; i < 2; i++) {
+            __m256i chunk = _mm256_loadu_si256((const __m256i*)(block + 32 * i));
+            __m256i folded = _mm256_or_si256(chunk, lowercase);
+            int shift = 32 * i;
+
+            __m256i ws = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, tab)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, carriage), _mm256_cmpeq_epi8(chunk, newline))
+            );
+            __m256i op = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, comma))
+            );
+
+            masks.quote |= uint64_t((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote))) << shift;
+            masks.backslash |= uint64_t((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash))) << shift;
+            masks.whitespace |= uint64_t((uint32_t)_mm256_movemask_epi8(ws)) << shift;
+            masks.op |= uint64_t((uint32_t)_mm256_movemask_epi8(op)) << shift;
+        }
+    }
+
+#endif
+
+
+    /************************** Structural Index **************************/
+
+    /**
+     * The best kernel supported by the running cpu
+     */
+    StructuralIndex::Kernel StructuralIndex::detect() {
+#if defined(STRUCTURAL_INDEX_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return Kernel::AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return Kernel::SSE42;
+#elif defined(STRUCTURAL_INDEX_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        bool sse42 = (info[2] >> 20) & 1;
+        bool osxsave = (info[2] >> 27) & 1;
+
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] >> 5) & 1;
+
+        if (avx2 && osxsave && (_xgetbv(0) & 6) == 6) return Kernel::AVX2;
+        if (sse42) return Kernel::SSE42;
+#endif
+        return Kernel::Scalar;
+    }
+
+    const char* StructuralIndex::name(Kernel kernel) {
+        switch (kernel) {
+            case Kernel::AVX2: return "avx2";
+            case Kernel::SSE42: return "sse4.2";
+            default: return "scalar";
+        }
+    }
+
+    /**
+     * Indexes <text> with the best kernel
+     */
+    void StructuralIndex::build(string_view text) {
+        static const Kernel kernel = detect();
+        build(text, kernel);
+    }
+
+    void StructuralIndex::build(string_view text, Kernel kernel) {
+        _positions.clear();
+        _built = false;
+
+        if (text.size() >= UINT32_MAX)
+            return;
+
+        Classifier classify = classifyScalar;
+#ifdef STRUCTURAL_INDEX_X86
+        if (kernel == Kernel::AVX2) classify = classifyAVX2;
+        else if (kernel == Kernel::SSE42) classify = classifySSE42;
+#endif
+
+        _positions.reserve(text.size() / 4 + 64);
+
+        /**
+         * State carried from one block to the next
+         */
+        uint64_t prevInString = 0;
+        uint64_t prevEscaped = 0;
+        uint64_t prevSeparator = 1;
+
+        const char* data = text.data();
+        size_t size = text.size();
+        char tail[64];
+
+        for (size_t offset = 0; offset < size; offset += 64) {
+
+            const char* block = data + offset;
+
+            /**
+             * The last block is padded with whitespace
+             */
+            if (size - offset < 64) {
+                memset(tail, ' ', sizeof(tail));
+                memcpy(tail, block, size - offset);
+                block = tail;
+            }
+
+            BlockMasks masks;
+            classify(block, masks);
+
+            uint64_t escaped = escapedChars(masks.backslash, prevEscaped);
+            uint64_t quote = masks.quote & ~escaped;
+
+            /**
+             * From the opening quote (included) to the closing one (excluded)
+             */
+            uint64_t inString = prefixXor(quote) ^ prevInString;
+            prevInString = (uint64_t)((int64_t)inString >> 63);
+
+            uint64_t op = masks.op & ~inString;
+            uint64_t separator = op | quote | (masks.whitespace & ~inString);
+
+            /**
+             * A scalar starts at any other char outside of
+             * a string that follows a separator
+             */
+            uint64_t follows = (separator << 1) | prevSeparator;
+            prevSeparator = separator >> 63;
+            uint64_t scalar = ~(separator | inString) & follows;
+
+            uint64_t bits = op | quote | scalar;
+
+            size_t length = _positions.size();
+            _positions.resize(length + popCount(bits));
+
+            uint32_t* out = _positions.data() + length;
+            while (bits) {
+                *out++ = (uint32_t)(offset + trailingZeros(bits));
+                bits &= bits - 1;
+            }
+        }
+
+        _built = true;
+    }
+
+} // namespace JsonSer
@@ -0,0 +1,64 @@
+#ifndef STRUCTURAL_INDEX_API
+#define STRUCTURAL_INDEX_API
+
+/**
+ * Libraries
+ */
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * First stage of the parser: a vectorized pass over the
+     * input that records the position of every
+     * - structural char ({ } [ ] : ,) outside of strings
+     * - unescaped quote (both the opening and the closing one)
+     * - first char of a scalar (number, true, false, null...)
+     *
+     * The second stage (the parser) jumps from one position to the
+     * next one instead of walking whitespace and strings char by char
+     */
+    class StructuralIndex {
+
+        vector<uint32_t> _positions;
+        bool _built = false;
+
+        public: /**************** public members ****************/
+
+        /**
+         * The kernel used to classify the input
+         */
+        enum class Kernel
+        {
+            Scalar,
+            SSE42,
+            AVX2
+        };
+
+        /**
+         * Indexes <text>, inputs bigger than 4GB are not indexed
+         */
+        void build(string_view);
+        void build(string_view, Kernel);
+
+        /**
+         * Returns true if the index has been built
+         */
+        bool isBuilt() const { return _built; }
+
+        /**
+         * The best kernel supported by the running cpu
+         */
+        static Kernel detect();
+        static const char* name(Kernel);
+
+        const vector<uint32_t>& Positions() const { return _positions; }
+    };
+
+} // namespace JsonSer
+
+#endif
@@ -0,0 +1,184 @@
+#include "ThreadPool.h"
+
+namespace JsonSer
+{
+
+    /**
+     * True on the threads of a pool and while
+     * the calling thread runs a loop
+     */
+    static thread_local bool insideLoop = false;
+
+    /************************** Thread Pool ********************************/
+
+    ThreadPool::ThreadPool(size_t threads)
+        :_remaining(0)
+    {
+        if (threads == 0)
+            threads = thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+
+        for (size_t i = 0; i < threads; i++)
+            _queues.push_back(make_unique<Queue>());
+
+        /**
+         * The last queue belongs to the calling thread
+         */
+        for (size_t i = 0; i + 1 < threads; i++)
+            _threads.emplace_back([this, i]() { loop(i); });
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            lock_guard<mutex> guard(_lock);
+            _stopping = true;
+        }
+        _wake.notify_all();
+
+        for (auto& t : _threads)
+            t.join();
+    }
+
+    bool ThreadPool::take(size_t worker, size_t& task) {
+        {
+            Queue& own = *_queues[worker];
+            lock_guard<mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+
+        for (size_t i = 1; i < _queues.size(); i++) {
+            Queue& other = *_queues[(worker + i) % _queues.size()];
+            lock_guard<mutex> guard(other.lock);
+            if (!other.tasks.empty()) {
+                task = other.tasks.front();
+                other.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::work(size_t worker) {
+        size_t task;
+
+        while (take(worker, task)) {
+            try {
+                (*_task)(task);
+            }
+            catch (...) {
+                lock_guard<mutex> guard(_lock);
+                if (!_error)
+                    _error = current_exception();
+            }
+
+            if (_remaining.fetch_sub(1, memory_order_acq_rel) == 1) {
+                lock_guard<mutex> guard(_lock);
+                _done.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::loop(size_t worker) {
+        insideLoop = true;
+        size_t generation = 0;
+
+        while (true) {
+            {
+                unique_lock<mutex> guard(_lock);
+                _wake.wait(guard, [&]() { return _stopping || _generation != generation; });
+                if (_stopping)
+                    return;
+                generation = _generation;
+            }
+            work(worker);
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t count, const function<void(size_t)>& task) {
+        if (count == 0)
+            return;
+
+        if (insideLoop || _queues.size() == 1 || count == 1) {
+            for (size_t i = 0; i < count; i++)
+                task(i);
+            return;
+        }
+
+        lock_guard<mutex> running(_running);
+        insideLoop = true;
+
+        _task = &task;
+        _remaining.store(count, memory_order_relaxed);
+
+        /**
+         * Contiguous blocks, so that the tasks of a
+         * worker are next to each other in the input
+         */
+        size_t workers = _queues.size();
+        for (size_t w = 0; w < workers; w++) {
+            Queue& queue = *_queues[w];
+            lock_guard<mutex> guard(queue.lock);
+            for (size_t i = count * w / workers; i < count * (w + 1) / workers; i++)
+                queue.tasks.push_back(i);
+        }
+
+        {
+            lock_guard<mutex> guard(_lock);
+            _generation++;
+        }
+        _wake.notify_all();
+
+        work(workers - 1);
+
+        {
+            unique_lock<mutex> guard(_lock);
+            _done.wait(guard, [&]() { return _remaining.load(memory_order_acquire) == 0; });
+        }
+
+        _task = nullptr;
+        insideLoop = false;
+
+        if (_error) {
+            exception_ptr error = _error;
+            _error = nullptr;
+            rethrow_exception(error);
+        }
+    }
+
+    ThreadPool& ThreadPool::shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    ThreadPool& ThreadPool::of(size_t threads) {
+        if (threads == 0)
+            return shared();
+
+        static mutex lock;
+        static map<size_t, unique_ptr<ThreadPool>> pools;
+
+        lock_guard<mutex> guard(lock);
+        unique_ptr<ThreadPool>& pool = pools[threads];
+        if (!pool)
+            pool = make_unique<ThreadPool>(threads);
+        return *pool;
+    }
+
+    void ThreadPool::run(size_t threads, size_t count, const function<void(size_t)>& task) {
+        /**
+         * A loop that runs on the calling thread only needs no pool
+         */
+        if (threads != 0 && (insideLoop || threads == 1 || count <= 1)) {
+            for (size_t i = 0; i < count; i++)
+                task(i);
+            return;
+        }
+        of(threads).parallelFor(count, task);
+    }
+
+} // namespace JsonSer
@@ -0,0 +1,133 @@
+#ifndef THREAD_POOL_API
+#define THREAD_POOL_API
+
+/**
+ * Libraries
+ */
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace JsonSer
+{
+    using namespace std;
+
+    /**
+     * A work-stealing pool for parallel loops
+     *
+     * The tasks of a loop are split in contiguous blocks, one block in
+     * the queue of each worker. A worker takes its own tasks from the
+     * back of its queue, when it has none left it steals from the front
+     * of the queue of another worker. The calling thread works too
+     */
+    class ThreadPool {
+
+        /**
+         * Tasks of a worker (indexes of the current loop)
+         */
+        struct Queue
+        {
+            mutex lock;
+            deque<size_t> tasks;
+        };
+
+        vector<thread> _threads;
+        vector<unique_ptr<Queue>> _queues;
+
+        /**
+         * The current loop
+         */
+        const function<void(size_t)>* _task = nullptr;
+        atomic<size_t> _remaining;
+        size_t _generation = 0;
+        bool _stopping = false;
+
+        /**
+         * The first exception thrown by a task of the current loop
+         */
+        exception_ptr _error;
+
+        mutex _lock;
+        condition_variable _wake;
+        condition_variable _done;
+
+        /**
+         * Only one loop at a time
+         */
+        mutex _running;
+
+        /**
+         * Runs tasks until there are none left to take or steal
+         */
+        void work(size_t worker);
+
+        /**
+         * Body of the threads
+         */
+        void loop(size_t worker);
+
+        /**
+         * Takes a task from the back of the own
+         * queue or the front of another one
+         */
+        bool take(size_t worker, size_t& task);
+
+        public: /**************** public members ****************/
+
+        /**
+         * A pool with <threads> workers counting the calling
+         * thread (0 is one per hardware thread)
+         */
+        explicit ThreadPool(size_t threads = 0);
+
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * Number of workers counting the calling thread
+         */
+        size_t size() const { return _queues.size(); }
+
+        /**
+         * Calls <task> with every index in [0, count) and returns when
+         * all of them are done. A loop started from inside a task
+         * runs on the calling thread only. The first exception thrown
+         * by a task is thrown again once the loop is done
+         */
+        void parallelFor(size_t count, const function<void(size_t)>& task);
+
+        /**
+         * A pool with a worker per hardware thread
+         */
+        static ThreadPool& shared();
+
+        /**
+         * The pool selected by <threads>: the shared pool for 0, otherwise
+         * a pool of <threads> workers that is created by the first call
+         * with that many and kept, like the shared one
+         */
+        static ThreadPool& of(size_t threads);
+
+        /**
+         * A loop on the pool selected by <threads>
+         */
+        static void run(size_t threads, size_t count, const function<void(size_t)>& task);
+
+        /**
+         * Number of workers run() uses for <threads>
+         */
+        static size_t workers(size_t threads) { return threads ? threads : shared().size(); }
+    };
+
+} // namespace JsonSer
+
+#endif
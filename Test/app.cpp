@@ -1,10 +1,97 @@
 #include "../Json/Json.h"
+#include "../Json/AccountingResource.h"
+#include "../Json/JsonBinary.h"
+#include "../Json/JsonBinding.h"
+#include "../Json/JsonDocument.h"
+#include "../Json/JsonPath.h"
+#include "../Json/JsonPushParser.h"
+#include "../Json/JsonReader.h"
+#include "../Json/JsonSchema.h"
+#include "../Json/JsonSlots.h"
+#include "../Json/JsonSnapshot.h"
+#include "../Json/JsonWriter.h"
+#include "../Json/ParseStats.h"
+#include "../Json/StructuralIndex.h"
 #include "./Test.h"
 
 #include <bits/stdc++.h>
 
 using namespace std;
 
+/**
+ * Counts the ints of a json and stops at the first string
+ */
+struct IntCounter : JsonSer::JsonHandler {
+    int ints = 0;
+    bool stopAtString = false;
+
+    bool onInt(long long) { ints++; return true; }
+    bool onString(string_view) { return !stopAtString; }
+};
+
+/**
+ * Bound structs of the figures of static/figure.json
+ */
+struct Dimension {
+    int width = 0;
+    int height = 0;
+};
+JSON_FIELDS(Dimension, width, height)
+
+struct Figure {
+    string name;
+    Dimension dimension;
+    vector<vector<int>> ranges;
+    optional<string> author;
+    map<string, double> weights;
+    JsonSer::Json extra;
+};
+JSON_FIELDS(Figure, name, dimension, ranges, author, weights, extra)
+
+/**
+ * Counts the allocations of the program, every replaceable form
+ * of new and delete is replaced (so that they all match)
+ */
+static atomic<size_t> allocations(0);
+
+static void* allocate(size_t size) {
+    allocations++;
+    if (void* memory = malloc(size ? size : 1))
+        return memory;
+    throw bad_alloc();
+}
+static void deallocate(void* memory) noexcept { free(memory); }
+
+/**
+ * Over-aligned memory is taken from a bigger block,
+ * the block is kept right before the memory
+ */
+static void* allocate(size_t size, align_val_t alignment) {
+    uintptr_t mask = (uintptr_t)alignment - 1;
+    char* block = (char*)allocate(size + (size_t)mask + sizeof(void*));
+    void** memory = (void**)(((uintptr_t)block + sizeof(void*) + mask) & ~mask);
+    memory[-1] = block;
+    return memory;
+}
+static void deallocate(void* memory, align_val_t) noexcept {
+    if (memory)
+        free(((void**)memory)[-1]);
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, align_val_t alignment) { return allocate(size, alignment); }
+void* operator new[](size_t size, align_val_t alignment) { return allocate(size, alignment); }
+
+void operator delete(void* memory) noexcept { deallocate(memory); }
+void operator delete[](void* memory) noexcept { deallocate(memory); }
+void operator delete(void* memory, size_t) noexcept { deallocate(memory); }
+void operator delete[](void* memory, size_t) noexcept { deallocate(memory); }
+void operator delete(void* memory, align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete[](void* memory, align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete(void* memory, size_t, align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete[](void* memory, size_t, align_val_t alignment) noexcept { deallocate(memory, alignment); }
+
 string readFile(const std::string& fileName) {
     
     ifstream fin(fileName);
@@ -164,7 +251,7 @@ int main() {
         });
 
         TestAPI::ASSERT(
-            (json.toString() == "{\"width\":10,\"height\":20}")
+            (json.toString() == "{\"height\":20,\"width\":10}")
         );
     }
     /**
@@ -175,7 +262,7 @@ int main() {
         Json json = Json::fromString("{\"height\":20,\"width\":10}");
 
         TestAPI::ASSERT(
-            (json.toString() == "{\"width\":10,\"height\":20}")
+            (json.toString() == "{\"height\":20,\"width\":10}")
         );
     }
 
@@ -190,7 +277,7 @@ int main() {
         });
 
         TestAPI::ASSERT(
-            (json.toString() == "[10,230,\"Mario\",34.760000,true,false,null]")
+            (json.toString() == "[10,230,\"Mario\",34.76,true,false,null]")
         );
     }
     /**
@@ -201,7 +288,1051 @@ int main() {
         Json json = Json::fromString("[10,230,\"Mario\",34.760000,true,false,null]");
 
         TestAPI::ASSERT(
-            (json.toString() == "[10,230,\"Mario\",34.760000,true,false,null]")
+            (json.toString() == "[10,230,\"Mario\",34.76,true,false,null]")
+        );
+    }
+
+    /**
+     * Numbers
+     */
+    {
+        TestAPI::TEST("NUMBERS");
+        Json json = Json::fromString("[-12, -0.5, 1e3, 2.5E-3, 12345678901234567890, 0.1, 1.0, 5e-324, 1.7976931348623157e308]");
+
+        /**
+         * Out of range and malformed numbers are reported
+         */
+        bool rejected = true;
+        const string longInt = "1" + string(400, '0');
+        const string longFraction = "0." + string(400, '0') + "1";
+        for (const string& number : { string("1E400"), string("-1e400"), string("1e"), string("1e+"), string("-"),
+            string("0123"), string("-00"), string("1."), string("1.e5"), string("-1.E"), longInt }) {
+            vector<string> diagnostics;
+            Json value = Json::fromString(number, diagnostics);
+            rejected = rejected && (diagnostics.size() == 1) && (value.toString() == "undefined");
+        }
+
+        TestAPI::ASSERT(
+            (json[0] == -12) &&
+            (json[1] == -0.5) &&
+            (json[2] == 1000.0) &&
+            (json[3] == 0.0025) &&
+            (json[4] == 12345678901234567890.0) &&
+            (json.toString() == "[-12,-0.5,1000.0,0.0025,12345678901234567168.0,0.1,1.0,5e-324,1.7976931348623157e+308]") &&
+            (Json::fromString(json.toString()).toString() == json.toString()) &&
+            rejected && (Json::fromString("1e-400").toString() == "0.0") &&
+            (Json::fromString("-1e-400").toString() == "-0.0") &&
+            (Json::fromString(longFraction).toString() == "0.0") &&
+            (Json::fromString("[0, -0, 0.5, 0e5, 10]").toString() == "[0,0,0.5,0.0,10]")
+        );
+    }
+
+    /**
+     * Compact values
+     */
+    {
+        TestAPI::TEST("COMPACT VALUES");
+        size_t before = allocations;
+        Json shortString = "fourteen chars";
+        size_t shortAllocations = allocations - before;
+
+        before = allocations;
+        Json longString = "fifteen chars!!";
+        size_t longAllocations = allocations - before;
+
+        Json array = JsonArray({ shortString, longString, 1, 2.5, true, nullptr });
+        Json copy = array;
+        copy = array[1];
+        array = Json();
+
+        /**
+         * A child assigned to its parent is copied before the parent is released
+         */
+        Json parent = Json::fromString("{\"a\":{\"b\":[1,\"a string longer than fourteen chars\"]}}");
+        parent = parent["a"];
+        parent = parent["b"];
+        Json element = JsonArray({ "a string longer than fourteen chars" });
+        element = element[0];
+
+        TestAPI::ASSERT(
+            (sizeof(Json) == 16) &&
+            (shortAllocations == 0) &&
+            (longAllocations == 1) &&
+            (shortString == "fourteen chars") &&
+            (longString == string("fifteen chars!!")) &&
+            (copy == "fifteen chars!!") &&
+            (parent.toString() == "[1,\"a string longer than fourteen chars\"]") &&
+            (element == "a string longer than fourteen chars") &&
+            (Json::fromString("[\"a\",\"a string longer than fourteen chars\"]").toString() ==
+                "[\"a\",\"a string longer than fourteen chars\"]")
+        );
+    }
+
+    /**
+     * Move semantics
+     */
+    {
+        TestAPI::TEST("MOVE SEMANTICS");
+        const string text(100, 'x');
+        pmr::string buffer(text, Json::heap());
+        Json longString = text;
+        Json::Array items(Json::heap());
+        items.reserve(8);
+        items.push_back(1);
+
+        size_t before = allocations;
+        Json array(std::move(items));
+        size_t arrayAllocations = allocations - before;
+
+        before = allocations;
+        Json moved = std::move(array);
+        array = std::move(moved);
+        array.push_back(std::move(longString));
+        array.emplace_back(2.5);
+        Json taken(std::move(buffer));
+        size_t moveAllocations = allocations - before;
+
+        before = allocations;
+        Json::Object direct;
+        direct.reserve(2);
+        direct.insert({ "width", 10 });
+        direct.insert({ "height", 20 });
+        size_t directAllocations = allocations - before;
+
+        before = allocations;
+        Json object = JsonObject({ { "width", 10 }, { "height", 20 } });
+        size_t objectAllocations = allocations - before;
+
+        object.set("width", 30);
+        object.emplace("height", 40);
+        object.emplace("depth", 5);
+
+        /**
+         * A child moved into its parent is taken before the parent is released
+         */
+        Json parent = Json::fromString("{\"a\":{\"b\":[1,\"a string longer than fourteen chars\"]}}");
+        parent = std::move(parent["a"]);
+        parent = std::move(parent["b"]);
+
+        TestAPI::ASSERT(
+            (parent.toString() == "[1,\"a string longer than fourteen chars\"]") &&
+            (arrayAllocations == 1) &&
+            (moveAllocations == 1) &&
+            (objectAllocations == directAllocations + 1) &&
+            (array.toString() == "[1,\"" + text + "\",2.5]") &&
+            (moved.toString() == "undefined") &&
+            (longString.toString() == "undefined") &&
+            (taken == text) &&
+            (object["width"] == 30) &&
+            (object["height"] == 20) &&
+            (object["depth"] == 5)
+        );
+    }
+
+    /**
+     * Object store
+     */
+    {
+        TestAPI::TEST("OBJECT STORE");
+        Json json = JsonObject();
+        string text = "{";
+
+        for (int i = 0; i < 100; i++) {
+            json.set("key" + to_string(99 - i), i);
+            text += (i ? ",\"key" : "\"key") + to_string(99 - i) + "\":" + to_string(i);
+        }
+        text += "}";
+
+        bool found = true;
+        for (int i = 0; i < 100; i++)
+            found = found && (json["key" + to_string(99 - i)] == i);
+
+        json.set("key50", -1);
+        json.emplace("key51", -1);
+
+        bool missing = false;
+        try { json["absent"]; } catch (const out_of_range&) { missing = true; }
+
+        Json duplicates = Json::fromString("{\"a\":1,\"b\":2,\"a\":3}");
+
+        TestAPI::ASSERT(
+            found && missing &&
+            (json["key50"] == -1) &&
+            (json["key51"] == 48) &&
+            (Json::fromString(text).toString() == text) &&
+            (duplicates.toString() == "{\"a\":1,\"b\":2}")
+        );
+    }
+
+    /**
+     * Key interning
+     */
+    {
+        TestAPI::TEST("KEY INTERNING");
+        string text = "[";
+        for (int i = 0; i < 100; i++)
+            text += string(i ? "," : "") + "{\"description\":\"a name longer than fourteen\",\"id\":" + to_string(i) + "}";
+        text += "]";
+
+        vector<string> diagnostics;
+        Json::ParseOptions plain;
+        plain.internKeys = false;
+        Json::ParseOptions interned;
+        interned.internStrings = true;
+
+        /**
+         * Each repeated key and string is one allocation less (the
+         * pool takes a few), keys of 7 chars or less are inline
+         */
+        size_t before = allocations;
+        Json::Key inlineKey("width");
+        Json::Key copiedKey = inlineKey;
+        size_t inlineAllocations = allocations - before;
+
+        before = allocations;
+        Json first = Json::fromString(text, diagnostics, plain);
+        size_t plainAllocations = allocations - before;
+
+        before = allocations;
+        Json second = Json::fromString(text, diagnostics, interned);
+        size_t internedAllocations = allocations - before;
+
+        TestAPI::ASSERT(
+            (first.toString() == text) &&
+            (second.toString() == text) &&
+            (second[99]["id"] == 99) &&
+            (plainAllocations - internedAllocations >= 99 + 99 - 8) &&
+            (sizeof(Json::Key) == 8) && (inlineAllocations == 0) &&
+            (copiedKey == Json::Key(string("width"))) && (copiedKey.view() == "width") &&
+            (copiedKey.hash() == Json::Key::hashOf("width")) &&
+            diagnostics.empty()
+        );
+    }
+
+    /**
+     * Ownership
+     */
+    {
+        TestAPI::TEST("OWNERSHIP");
+        const string text = "{\"items\":[1,\"a string longer than fourteen chars\",{\"id\":2}]}";
+        Json json = Json::fromString(text, Json::Ownership::Local);
+        Json items = json["items"];
+        bool local = !json.isShared();
+
+        bool sharedByOtherThread = true;
+        thread([&]() { sharedByOtherThread = json.share(); }).join();
+
+        bool shared = json.share();
+        string copied;
+        thread([&]() { Json copy = json; copied = copy.toString(); }).join();
+
+        TestAPI::ASSERT(
+            local &&
+            !sharedByOtherThread &&
+            shared &&
+            json.isShared() &&
+            (copied == text) &&
+            (items[2]["id"] == 2) &&
+            Json::fromString(text).isShared()
+        );
+    }
+
+    /**
+     * Json path
+     */
+    {
+        TestAPI::TEST("JSON PATH");
+        Json json = Json::fromString(readFile("./static/figure.json"));
+        Json escaped = Json::fromString("{\"a/b\":{\"m~n\":[10,20,30]},\"7\":true}");
+
+        JsonPath width("/0/dimension/width");
+        JsonPath cell("$[0].ranges[-1][1]");
+        JsonPath names("$[*]['name']");
+        JsonPath pointer("/a~1b/m~0n/2");
+        JsonPath numericKey("/7");
+        JsonPath missing("/0/dimension/depth");
+        JsonPath broken("$.ranges[0");
+
+        vector<Json*> matches;
+
+        size_t before = allocations;
+        bool found = width.find(json) && cell.find(json) && !missing.find(json);
+        size_t findAllocations = allocations - before;
+
+        TestAPI::ASSERT(
+            found && (findAllocations == 0) &&
+            (*width.find(json) == 38) &&
+            (*cell.find(json) == 3) &&
+            (names.findAll(json, matches) == 1) &&
+            (*matches[0] == "gosper's-glider-cannon") &&
+            (*pointer.find(escaped) == 30) &&
+            (*numericKey.find(escaped) == true) &&
+            (JsonPath("").find(json) == &json) &&
+            (missing.find(json) == nullptr) &&
+            (JsonPath("/0/ranges/-").find(json) == nullptr) &&
+            !broken.isValid() &&
+            (broken.Diagnostics().size() == 1) &&
+            (broken.find(json) == nullptr)
+        );
+    }
+
+    /**
+     * Lazy parsing
+     */
+    {
+        TestAPI::TEST("LAZY PARSING");
+        string text = "[";
+        for (int i = 0; i < 200; i++)
+            text += string(i ? "," : "") + "{\"id\":" + to_string(i) + ",\"tags\":[\"a\",\"b \\\"]\"],\"child\":{\"x\":[1,2,3]}}";
+        text += "]";
+
+        Json::ParseOptions options;
+        options.lazy = true;
+        vector<string> diagnostics;
+
+        size_t before = allocations;
+        Json eager = Json::fromString(text);
+        size_t eagerAllocations = allocations - before;
+
+        before = allocations;
+        Json lazy = Json::fromString(text, diagnostics, options);
+        bool found = (lazy[150]["id"] == 150) && (lazy[150]["tags"][1] == "b \\\"]");
+        size_t lazyAllocations = allocations - before;
+
+        Json shared = Json::fromString(text, diagnostics, options);
+        atomic<int> matches(0);
+        vector<thread> threads;
+        for (int t = 0; t < 4; t++)
+            threads.emplace_back([&]() { if (shared[199]["child"]["x"][2] == 3) matches++; });
+        for (auto& t : threads)
+            t.join();
+        bool concurrent = matches == 4;
+
+        Json file = Json::fromFile("./static/figure.json", diagnostics, options);
+
+        TestAPI::ASSERT(
+            found && concurrent &&
+            (lazyAllocations * 10 < eagerAllocations) &&
+            (lazy.toString() == eager.toString()) &&
+            (shared.toString() == text) &&
+            (file[0]["dimension"]["width"] == 38) &&
+            (file.toString() == Json::fromFile("./static/figure.json").toString()) &&
+            diagnostics.empty()
+        );
+    }
+
+    /**
+     * Parse many
+     */
+    {
+        TestAPI::TEST("PARSE MANY");
+        string text;
+        for (int i = 0; i < 5000; i++)
+            text += "{\"id\":" + to_string(i) + ",\"msg\":\"line } ] \\\" " + to_string(i) + "\"}\n";
+        text += "[1,\n 2] \"a\"12 true{\"broken\" 1}\n";
+        text += "1x truex\n";
+
+        Json::ParseOptions options;
+        options.threads = 4;
+        auto records = Json::parseMany(text, options);
+
+        bool ordered = true;
+        for (int i = 0; i < 5000; i++)
+            ordered = ordered && (records[i].value["id"] == i) && records[i].diagnostics.empty();
+
+        TestAPI::ASSERT(
+            ordered &&
+            (records.size() == 5007) &&
+            (records[0].value["msg"] == "line } ] \\\" 0") &&
+            (records[5000].value.toString() == "[1,2]") &&
+            (records[5001].value == "a") &&
+            (records[5002].value == 12) &&
+            (records[5003].value == true) &&
+            (records[5004].diagnostics.size() == 1) &&
+            (records[5005].diagnostics.size() == 1) &&
+            (records[5006].diagnostics.size() == 1) &&
+            (Json::parseMany(text).size() == 5007) &&
+            Json::parseMany(" \n ").empty()
+        );
+    }
+
+    /**
+     * Parallel array
+     */
+    {
+        TestAPI::TEST("PARALLEL ARRAY");
+        string text = "[";
+        for (int i = 0; text.size() < Json::PARALLEL_ARRAY * 2; i++)
+            text += string(i ? ",\n" : "") + "{\"id\":" + to_string(i) + ",\"s\":\"[,] \\\" {\",\"a\":[1,[2,{\"b\":3}]]}";
+        text += "]";
+        size_t middle = text.find(",\n", text.size() / 2) + 2;
+        string broken = text.substr(0, middle) + "7 8," + text.substr(middle);
+
+        Json::ParseOptions serial;
+        serial.threads = 1;
+        Json::ParseOptions parallel;
+        parallel.threads = 4;
+
+        vector<string> serialDiagnostics, parallelDiagnostics;
+        Json expected = Json::fromString(text, serial);
+        Json json = Json::fromString(text, parallel);
+        Json::fromString(broken, serialDiagnostics, serial);
+        Json::fromString(broken, parallelDiagnostics, parallel);
+
+        /**
+         * A malformed element gives the tree, the diagnostics
+         * and the statistics of a serial parse
+         */
+        bool same = true;
+        for (size_t at : { (size_t)1, text.size() / 3, text.size() - 100 }) {
+            size_t element = text.find(",\n", at) + 2;
+            string malformed = text.substr(0, element) + "{\"id\" 1, [}" + text.substr(element);
+
+            ParseStats serialStats, parallelStats;
+            vector<string> serialReported, parallelReported;
+            serial.stats = &serialStats;
+            parallel.stats = &parallelStats;
+            Json serialTree = Json::fromString(malformed, serialReported, serial);
+            Json parallelTree = Json::fromString(malformed, parallelReported, parallel);
+
+            same = same && !serialReported.empty() && (parallelReported == serialReported) &&
+                (parallelTree.toString() == serialTree.toString()) &&
+                (parallelStats.objects == serialStats.objects) && (parallelStats.ints == serialStats.ints) &&
+                (parallelStats.keys == serialStats.keys) && (parallelStats.maxDepth == serialStats.maxDepth) &&
+                (parallelStats.diagnostics == serialStats.diagnostics);
+        }
+
+        TestAPI::ASSERT(
+            (json.toString() == expected.toString()) &&
+            (json[1000]["id"] == 1000) &&
+            !serialDiagnostics.empty() &&
+            (parallelDiagnostics == serialDiagnostics) &&
+            same
+        );
+    }
+
+    /**
+     * Parallel writer
+     */
+    {
+        TestAPI::TEST("PARALLEL WRITER");
+        Json::Object rows;
+        vector<Json> items;
+        for (int i = 0; i < 5000; i++) {
+            rows.try_emplace("row" + to_string(i), JsonArray({ i, "s\"" + to_string(i), 0.5 * i }));
+            items.push_back(JsonObject({ {"id", i}, {"tags", JsonArray({ "a", "b" })} }));
+        }
+        Json json = JsonObject({ {"rows", Json(std::move(rows))}, {"items", Json(std::move(items))}, {"n", 1} });
+        string expected = json.toString();
+
+        string text = "[";
+        {
+            JsonWriter writer(text);
+            writer.writeParallel(json, 4);
+        }
+
+        stringstream stream;
+        {
+            JsonWriter writer(stream);
+            writer.writeParallel(json, 4);
+        }
+
+        FILE* file = tmpfile();
+        {
+            JsonWriter writer(fileno(file));
+            writer.writeParallel(json, 4);
+        }
+        string written(expected.size() + 1, '\0');
+        rewind(file);
+        written.resize(fread(&written[0], 1, written.size(), file));
+        fclose(file);
+
+        TestAPI::ASSERT(
+            (text == "[" + expected) &&
+            (stream.str() == expected) &&
+            (written == expected)
+        );
+    }
+
+    /**
+     * Binary formats
+     */
+    {
+        TestAPI::TEST("BINARY FORMATS");
+        Json json = JsonObject({
+            {"int", -100000}, {"null", nullptr}, {"undefined", Json()}, {"float", 0.1}, {"half", 1.5},
+            {"bool", true}, {"short", "Mario"}, {"long", string(300, 'x')},
+            {"array", JsonArray({ 1, -1, 255, -129, 1LL << 40, JsonObject({ {"a", "b"} }) })}
+        });
+
+        string cbor = json.toCBOR();
+        string messagePack = json.toMessagePack();
+
+        stringstream stream;
+        {
+            CborWriter writer(stream);
+            writer.startObject();
+            writer.key("x");
+            writer.startArray();
+            writer.writeInt(1);
+            writer.end();
+            writer.end();
+        }
+
+        vector<string> truncated, unknown;
+        Json::fromCBOR(string_view(cbor).substr(0, cbor.size() - 3), truncated);
+        Json::fromMessagePack(string_view("\x92\x01\xd4\x05\x00", 5), unknown);
+
+        TestAPI::ASSERT(
+            (Json::fromCBOR(cbor).toString() == json.toString()) &&
+            (Json::fromMessagePack(messagePack).toString() == json.toString()) &&
+            (JsonArray({ 1, -1 }).toCBOR() == "\x82\x01\x20") &&
+            (Json().toCBOR() == "\xf7") &&
+            (JsonObject({ {"a", 1} }).toMessagePack() == "\x81\xa1" "a" "\x01") &&
+            (Json::fromCBOR(stream.str()).toString() == "{\"x\":[1]}") &&
+            (Json::fromCBOR(string_view("\xf9\x3c\x00", 3)) == 1.0) &&
+            (truncated.size() == 1) &&
+            (unknown.size() == 1)
+        );
+    }
+
+    /**
+     * Snapshot
+     */
+    {
+        TestAPI::TEST("SNAPSHOT");
+        Json::Object wide;
+        for (int i = 0; i < 100; i++)
+            wide.try_emplace("key" + to_string(i), JsonArray({ i, "value" + to_string(i) }));
+
+        Json json = JsonObject({
+            {"name", "Mario"}, {"height", 1.75}, {"age", 30}, {"alive", true}, {"car", nullptr},
+            {"wide", Json(std::move(wide))}, {"list", JsonArray({ JsonObject({ {"name", "Luigi"} }), Json() })}
+        });
+
+        string bytes = JsonSnapshot::encode(json);
+        JsonSnapshot snapshot(string_view(bytes.data(), bytes.size()));
+        JsonSnapshot::Value root = snapshot.root();
+
+        JsonSnapshot::save(json, "./snapshot.bin");
+        JsonSnapshot file("./snapshot.bin");
+        remove("./snapshot.bin");
+
+        string damaged = bytes;
+        damaged[0] = 'X';
+        JsonSnapshot broken(string_view(damaged.data(), damaged.size()));
+
+        size_t before = allocations;
+        bool found = (root["wide"]["key42"][1].asString() == "value42") && (root["list"][0]["name"].asString() == "Luigi");
+        size_t allocated = allocations - before;
+
+        TestAPI::ASSERT(
+            snapshot.isValid() && found && (allocated == 0) &&
+            (root["name"].asString() == "Mario") &&
+            (root["height"].asFloat() == 1.75) &&
+            (root["age"].asInt() == 30) &&
+            root["alive"].asBool() && root["car"].isNull() &&
+            root["missing"].isUndefined() && root["list"][5].isUndefined() &&
+            (root.key(1) == "height") && (root["wide"].size() == 100) &&
+            (root.toJson().toString() == json.toString()) &&
+            file.isValid() && (file.root().toJson().toString() == json.toString()) &&
+            !broken.isValid() && (broken.Diagnostics().size() == 1) && broken.root().isUndefined()
+        );
+    }
+
+    /**
+     * Memory accounting
+     */
+    {
+        TestAPI::TEST("MEMORY ACCOUNTING");
+        const string& figure = readFile("./static/figure.json");
+        const string expected = Json::fromString(figure).toString();
+
+        AccountingResource memory;
+        Json::ParseOptions options;
+        options.resource = &memory;
+
+        Json document = Json::fromString(figure, options);
+        size_t live = memory.live(), peak = memory.peak();
+        bool owned = (document.resource() == &memory) && (document.toString() == expected);
+        Json copy = document;
+        document = Json();
+        size_t shared = memory.live();
+        copy = Json();
+
+        AccountingResource small(live / 2);
+        options.resource = &small;
+        bool refused = false;
+        try {
+            Json::fromString(figure, options);
+        }
+        catch (const bad_alloc&) {
+            refused = true;
+        }
+
+        AccountingResource lazyMemory;
+        options.resource = &lazyMemory;
+        options.lazy = true;
+        Json lazy = Json::fromString(figure, options);
+        size_t shallow = lazyMemory.live();
+        bool materialized = (lazy.toString() == expected) && (lazyMemory.live() > shallow);
+
+        TestAPI::ASSERT(
+            owned && (live > 0) && (peak >= live) && (shared == live) &&
+            (memory.live() == 0) && (memory.allocations() == memory.deallocations()) &&
+            refused && (small.live() == 0) && (small.peak() <= live / 2) &&
+            materialized &&
+            (memory.toJson().toString() ==
+                "{\"live\":0,\"peak\":" + to_string(peak) + ",\"allocations\":" + to_string(memory.allocations()) +
+                ",\"deallocations\":" + to_string(memory.deallocations()) + ",\"budget\":null}")
+        );
+    }
+
+    /**
+     * Parse statistics
+     */
+    {
+        TestAPI::TEST("PARSE STATISTICS");
+        const string text = "{\"a\":[1,2.5,true,null,\"short\",\"a string longer than fourteen\"],\"b\":{\"c\":undefined}}";
+
+        ParseStats stats;
+        Json::ParseOptions options;
+        options.stats = &stats;
+        Json json = Json::fromString(text, options);
+
+        ParseStats broken;
+        vector<string> diagnostics;
+        options.stats = &broken;
+        Json::fromString("[1, @]", diagnostics, options);
+
+        /**
+         * The parallel parser counts the same values as the serial one
+         */
+        string big = "[";
+        for (int i = 0; big.size() < Json::PARALLEL_ARRAY; i++)
+            big += (i ? "," : "") + string("{\"id\":") + to_string(i) + ",\"tags\":[\"tag number " + to_string(i) + "\",0.5]}";
+        big += "]";
+
+        ParseStats serial, parallel;
+        options.stats = &serial;
+        options.threads = 1;
+        Json::fromString(big, options);
+        options.stats = &parallel;
+        options.threads = 4;
+        Json::fromString(big, options);
+
+        auto counts = [](const ParseStats& stats) {
+            Json json = stats.toJson();
+            json.set("scan_ns", 0);
+            json.set("number_ns", 0);
+            json.set("build_ns", 0);
+            return json.toString();
+        };
+
+        TestAPI::ASSERT(
+            (json["b"]["c"].toString() == "undefined") &&
+            (stats.bytes == text.size()) && (stats.ints == 1) && (stats.floats == 1) &&
+            (stats.bools == 1) && (stats.nulls == 1) && (stats.undefineds == 1) &&
+            (stats.strings == 2) && (stats.heapStrings == 1) && (stats.keys == 3) &&
+            (stats.objects == 2) && (stats.arrays == 1) && (stats.maxDepth == 2) &&
+            (stats.diagnostics == 0) && (stats.scanNanoseconds > 0) &&
+            (broken.diagnostics == diagnostics.size()) && !diagnostics.empty() && (broken.ints == 1) && (broken.undefineds == 1) &&
+            (serial.ints > 0) && (counts(serial) == counts(parallel)) &&
+            (stats.toJson()["max_depth"] == 2)
+        );
+    }
+
+    /**
+     * Struct binding
+     */
+    {
+        TestAPI::TEST("STRUCT BINDING");
+        const string& text = readFile("./static/figure.json");
+        Json tree = Json::fromString(text);
+
+        vector<Figure> figures;
+        bool read = JsonStruct::fromString(text, figures);
+
+        vector<Figure> again;
+        bool roundTrip = JsonStruct::fromString(JsonStruct::toString(figures), again) &&
+            (JsonStruct::toString(again) == JsonStruct::toString(figures));
+
+        Figure other;
+        other.dimension.width = 7;
+        bool readOther = JsonStruct::fromString(
+            "{\"name\":\"x\",\"author\":\"me\",\"unknown\":{\"a\":[1,{\"b\":\"]}\"}]},"
+            "\"weights\":{\"a\":0.5,\"b\":2},\"extra\":{\"k\":[1,2]},\"dimension\":{\"height\":2}}", other);
+
+        Dimension dimension;
+        size_t before = allocations;
+        bool readDimension = JsonStruct::fromString(" { \"height\" : 11, \"width\" : 38 } ", dimension);
+        size_t allocated = allocations - before;
+
+        vector<string> diagnostics;
+        Figure wrongType, outOfRange, invalidExtra;
+        bool rejected = !JsonStruct::fromString("{\"name\":1}", wrongType, diagnostics) &&
+            !JsonStruct::fromString("{\"dimension\":{\"width\":99999999999}}", outOfRange, diagnostics) &&
+            !JsonStruct::fromString("{\"extra\":[1,,2 x]}", invalidExtra, diagnostics);
+
+        map<string, uint64_t> unsignedInts = { { "max", numeric_limits<uint64_t>::max() } }, unsignedAgain;
+        vector<uint64_t> negative, tooBig;
+        bool unsignedRoundTrip = (JsonStruct::toString(unsignedInts) == "{\"max\":18446744073709551615}") &&
+            JsonStruct::fromString(JsonStruct::toString(unsignedInts), unsignedAgain) && (unsignedAgain == unsignedInts) &&
+            !JsonStruct::fromString("[-1]", negative) && !JsonStruct::fromString("[18446744073709551616]", tooBig);
+
+        vector<string> trailing, parsedTrailing;
+        Dimension followed;
+        bool rejectedTrailing = !JsonStruct::fromString("{\"width\":1,\"height\":2} garbage", followed, trailing) &&
+            JsonStruct::fromString("{\"width\":1,\"height\":2} \n", followed);
+        Json::fromString("{\"width\":1,\"height\":2} garbage", parsedTrailing);
+
+        TestAPI::ASSERT(
+            read && (figures.size() == 1) &&
+            (figures[0].name == tree[0]["name"]) &&
+            (figures[0].dimension.width == 38) && (figures[0].dimension.height == 11) &&
+            (figures[0].ranges.size() == 17) && (figures[0].ranges[16] == vector<int>{ 35, 3, 2, 2 }) &&
+            !figures[0].author && figures[0].weights.empty() && (figures[0].extra.toString() == "undefined") &&
+            roundTrip &&
+            readOther && (other.author == string("me")) && (other.weights["b"] == 2) &&
+            (other.extra["k"][1] == 2) && (other.dimension.width == 7) && (other.dimension.height == 2) &&
+            readDimension && (dimension.width == 38) && (dimension.height == 11) && (allocated == 0) &&
+            rejected && (diagnostics.size() == 3) && unsignedRoundTrip &&
+            rejectedTrailing && (trailing.size() == 1) && (trailing == parsedTrailing) &&
+            (JsonStruct::toString(dimension) == "{\"width\":38,\"height\":11}")
+        );
+    }
+
+    /**
+     * The reader and the cursor accept the same values
+     */
+    {
+        TestAPI::TEST("SHARED GRAMMAR");
+        bool same = true;
+
+        for (const char* text : { "1.5", "-0", "12345678901234567890", "1e-400", "1E400", "1e", "1e+", "-" }) {
+            vector<string> parsed, read;
+            Json json = Json::fromString(text, parsed);
+            double number = 0;
+            bool accepted = JsonStruct::fromString(text, number, read);
+            same = same && (accepted == parsed.empty()) && (read == parsed) && (!accepted || json == number || json == (long long)number);
+        }
+
+        for (const char* text : { "inf", "nan", "+1", ".5" }) {
+            vector<string> parsed;
+            Json::fromString(text, parsed);
+            double number = 0;
+            same = same && (parsed.size() == 1) && !JsonStruct::fromString(text, number);
+        }
+
+        for (const char* text : { "[]", "{ }", "undefined", "\"a \\\" b\"", "tru", "\"open", "[1, 2" }) {
+            vector<string> parsed, read;
+            Json json = Json::fromString(text, parsed);
+            Json skipped;
+            bool accepted = JsonStruct::fromString(text, skipped, read);
+            same = same && (accepted == parsed.empty()) && (!accepted || skipped.toString() == json.toString());
+        }
+
+        optional<int> missing = 1;
+        TestAPI::ASSERT(
+            same &&
+            (Json::fromString("[]").toString() == "[]") && (Json::fromString("{\"a\":{}}").toString() == "{\"a\":{}}") &&
+            JsonStruct::fromString("undefined", missing) && !missing
+        );
+    }
+
+    /**
+     * Known keys
+     */
+    {
+        TestAPI::TEST("KEY SET SLOTS");
+        static constexpr auto keys = JsonSer::makeKeySet("host", "port", "secure", "paths");
+        static constexpr auto sampled = JsonSer::makeKeySet("prefix-of-a-long-key-1-suffix", "prefix-of-a-long-key-2-suffix");
+        constexpr size_t PORT = keys.find("port");
+        static_assert(PORT == 1 && keys.find("portal") == keys.NOT_FOUND, "Slots are the positions of the keys");
+
+        JsonSer::JsonSlots slots(keys);
+        vector<string> diagnostics;
+        bool read = slots.fromString(
+            "{ \"port\" : 8080, \"paths\": [\"/a\", {\"b\": 1}], \"extra\": {\"k\": true}, \"port\": 1, \"host\": \"h\" }",
+            diagnostics);
+
+        JsonSer::JsonSlots again(keys);
+        bool rejected = !again.fromString("[1, 2]", diagnostics) && !again.fromString("{\"port\": 1, \"host\": @}", diagnostics);
+
+        JsonSer::JsonSlots undefinedFirst(keys);
+        vector<string> trailing;
+        bool firstWins = undefinedFirst.fromString("{\"port\": undefined, \"port\": 1}") &&
+            undefinedFirst.has(PORT) && (undefinedFirst[PORT].toString() == "undefined") &&
+            (undefinedFirst.toJson().toString() == "{\"port\":undefined}");
+        bool rejectedTrailing = !undefinedFirst.fromString("{\"port\": 1} {\"port\": 2}", trailing) && (trailing.size() == 1);
+
+        TestAPI::ASSERT(
+            read && (slots[PORT] == 8080) && (slots[0] == "h") && !slots.has(2) &&
+            (slots[3][1]["b"] == 1) && (slots.overflow().size() == 1) && (slots.find("extra") != nullptr) &&
+            (slots.find("secure") == nullptr) && (slots.find("none") == nullptr) &&
+            (slots.toJson().toString() == "{\"host\":\"h\",\"port\":8080,\"paths\":[\"/a\",{\"b\":1}],\"extra\":{\"k\":true}}") &&
+            rejected && (diagnostics.size() == 3) && (again[PORT] == 1) &&
+            firstWins && rejectedTrailing &&
+            (sampled.find("prefix-of-a-long-key-2-suffix") == 1) && !sampled.contains("prefix-of-a-long-key-3-suffix")
+        );
+    }
+
+    /**
+     * Schema validation while parsing
+     */
+    {
+        TestAPI::TEST("SCHEMA VALIDATION");
+        JsonSchema schema(Json::fromString(
+            "{\"type\": \"object\", \"required\": [\"id\", \"tags\"], \"properties\": {"
+            "\"id\": {\"type\": \"integer\", \"minimum\": 1},"
+            "\"name\": {\"type\": \"string\", \"maxLength\": 4},"
+            "\"kind\": {\"enum\": [\"a\", \"b\", 3]},"
+            "\"tags\": {\"type\": \"array\", \"items\": {\"type\": \"string\"}},"
+            "\"score\": {\"type\": [\"number\", \"null\"], \"maximum\": 10}}}"));
+
+        const string valid = "{\"id\": 3, \"name\": \"a\\\"b\\u00e9\", \"kind\": 3, \"tags\": [\"x\", \"y\"], \"score\": 2.5, \"extra\": [1, {\"a\": null}]}";
+        vector<string> diagnostics;
+        Json json = schema.parse(valid, diagnostics);
+        bool accepted = diagnostics.empty() && (json.toString() == Json::fromString(valid).toString()) && schema.validate(valid, diagnostics);
+
+        vector<string> violations;
+        bool rejected =
+            !schema.validate("{\"id\": 0, \"tags\": [\"x\"]}", violations) &&
+            !schema.validate("{\"id\": 1, \"name\": \"abcde\", \"tags\": [\"x\"]}", violations) &&
+            !schema.validate("{\"id\": 1, \"kind\": \"c\", \"tags\": [\"x\"]}", violations) &&
+            !schema.validate("{\"id\": 1, \"tags\": [\"x\", 2]}", violations) &&
+            !schema.validate("{\"id\": 1, \"score\": 10.5}", violations) &&
+            !schema.validate("{\"id\": 1}", violations) &&
+            !schema.validate("[1]", violations);
+
+        /**
+         * Nothing is built after the first violation: only the root object
+         * is allocated (the key "id" is inline), not the 1000 tags
+         */
+        string big = "{\"id\": -1, \"tags\": [";
+        for (int i = 0; i < 1000; i++)
+            big += (i ? ", \"" : "\"") + to_string(i) + "-a-tag-long-enough-to-be-allocated\"";
+        big += "]}";
+
+        AccountingResource memory;
+        Json::ParseOptions options;
+        options.resource = &memory;
+        vector<string> stopped;
+        bool undefined = schema.parse(big, stopped, options).toString() == "undefined";
+        size_t allocated = memory.allocations();
+
+        JsonSchema broken(Json::fromString("{\"type\": \"text\", \"maxLength\": -1}"));
+
+        TestAPI::ASSERT(
+            schema.isValid() && accepted &&
+            rejected && (violations.size() == 7) &&
+            (violations[0] == "Invalid value at position <8> ($.id) >>> A value >= 1.0 <<<") &&
+            (violations[3] == "Invalid value at position <25> ($.tags[1]) >>> A value of type string <<<") &&
+            (violations[5] == "Invalid value at position <9> ($) >>> The required member 'tags' <<<") &&
+            undefined && (stopped.size() == 1) && (allocated == 1) &&
+            !broken.isValid() && (broken.Diagnostics().size() == 2) && !broken.validate("1", diagnostics)
+        );
+    }
+
+    /**
+     * From file
+     */
+    {
+        TestAPI::TEST("FROM FILE");
+        vector<string> diagnostics;
+        Json json = Json::fromFile("./static/testarr.json");
+        Json missing = Json::fromFile("./static/missing.json", diagnostics);
+
+        TestAPI::ASSERT(
+            (json.toString() == "[1,2,\"Three\",null]") &&
+            (diagnostics.size() == 1)
+        );
+    }
+
+    /**
+     * Document
+     */
+    {
+        TestAPI::TEST("DOCUMENT");
+
+        const string& figure = readFile("./static/figure.json");
+
+        JsonDocument document = JsonDocument::fromString(figure);
+        Json json = Json::fromString(figure);
+
+        JsonRef root = document.root();
+
+        TestAPI::ASSERT(
+            (root.size() == 1) &&
+            (root[0]["name"].asString() == "gosper's-glider-cannon") &&
+            (root[0]["dimension"]["width"].asInt() == 38) &&
+            (root[0]["ranges"].size() == 17) &&
+            (root[0]["ranges"].toString() == json[0]["ranges"].toString()) &&
+            (root[0]["ranges"].toJson().toString() == json[0]["ranges"].toString()) &&
+            (!root[0]["missing"].isValid()) &&
+            (document.Diagnostics().empty())
+        );
+
+        /**
+         * The tape is sized from the structural index, the recovered
+         * values that aren't in the index get the worst case size
+         */
+        const string malformed = "[,,, {\"a\" 1}]";
+        JsonDocument recovered = JsonDocument::fromString(malformed);
+
+        TestAPI::ASSERT(
+            (document.capacity() < 8 * figure.size()) &&
+            (recovered.root().toString() == Json::fromString(malformed).toString()) &&
+            (recovered.Diagnostics().size() == 4)
+        );
+    }
+
+    /**
+     * Structural index
+     */
+    {
+        TestAPI::TEST("STRUCTURAL INDEX");
+
+        const string& figure = readFile("./static/figure.json");
+        string escaped = "[\"a\\\"b\", \"c\\\\\", 12, true]";
+
+        StructuralIndex scalar;
+        scalar.build(figure + escaped, StructuralIndex::Kernel::Scalar);
+
+        bool same = true;
+        for (int kernel = 0; kernel <= (int)StructuralIndex::detect(); kernel++) {
+            StructuralIndex index;
+            index.build(figure + escaped, (StructuralIndex::Kernel)kernel);
+            same = same && (index.Positions() == scalar.Positions());
+        }
+
+        Json json = Json::fromString(escaped);
+
+        TestAPI::ASSERT(
+            same &&
+            (json[0] == "a\\\"b") &&
+            (json[1] == "c\\\\") &&
+            (json[2] == 12) &&
+            (json[3] == true)
+        );
+    }
+
+    /**
+     * Push parser
+     */
+    {
+        TestAPI::TEST("PUSH PARSER");
+
+        const string& figure = readFile("./static/figure.json");
+        string stream = figure + "\n{\"id\":1}\n\"a \\\" b\" 12 true\n[1, 2";
+
+        JsonPushParser parser;
+        vector<Json> values;
+
+        for (size_t i = 0; i < stream.size(); i += 7) {
+            for (auto& value : parser.feed(string_view(stream).substr(i, 7)))
+                values.push_back(value);
+        }
+        for (auto& value : parser.finish())
+            values.push_back(value);
+
+        /**
+         * Every split of a stream gives the same values, an error
+         * is reported at its position in the stream and the parsing
+         * goes on after the broken value
+         */
+        string tricky = "[1, {\"a\": \"x \\\" y\", \"b\": [true, null, undefined, -1.5e3]}, \"s\\\\\"] [] {} [1 2] 3";
+        bool splits = true;
+        string first;
+
+        for (size_t size = 1; size <= tricky.size(); size++) {
+            JsonPushParser split;
+            string parsed;
+            for (size_t i = 0; i < tricky.size(); i += size) {
+                for (auto& value : split.feed(string_view(tricky).substr(i, size)))
+                    parsed += value.toString() + " ";
+            }
+            for (auto& value : split.finish())
+                parsed += value.toString() + " ";
+
+            if (size == 1) first = parsed;
+            splits = splits && (parsed == first) && (split.Diagnostics().size() == 1);
+        }
+
+        vector<string> broken;
+        Json::fromString("[1 2]", broken);
+
+        JsonPushParser located;
+        located.feed("[1 ");
+        located.feed("2] 3 ");
+
+        TestAPI::ASSERT(
+            (values.size() == 6) &&
+            (values[0].toString() == Json::fromString(figure).toString()) &&
+            (values[1]["id"] == 1) &&
+            (values[2] == "a \\\" b") &&
+            (values[3] == 12) &&
+            (values[4] == true) &&
+            (values[5].toString() == "[1,2]") &&
+            (parser.Diagnostics().size() == 1) &&
+            splits && (first == "[1,{\"a\":\"x \\\" y\",\"b\":[true,null,undefined,-1500.0]},\"s\\\\\"] [] {} [1] 3 ") &&
+            (located.Diagnostics() == broken) && !located.isInsideValue()
+        );
+    }
+
+    /**
+     * Event handler
+     */
+    {
+        TestAPI::TEST("EVENT HANDLER");
+
+        const string& figure = readFile("./static/figure.json");
+
+        IntCounter counter;
+        JsonReader<IntCounter> reader(figure, counter);
+        bool completed = reader.parse();
+
+        IntCounter stopper;
+        stopper.stopAtString = true;
+        JsonReader<IntCounter> stopped(figure, stopper);
+        bool stoppedCompleted = stopped.parse();
+
+        TestAPI::ASSERT(
+            completed && (counter.ints == 17 * 4 + 2) &&
+            !stoppedCompleted && (stopper.ints == 0)
+        );
+    }
+
+    /**
+     * Writer
+     */
+    {
+        TestAPI::TEST("WRITER");
+
+        Json json = JsonArray({ 10, "Mario", JsonArray(), JsonObject({ {"width", 10} }) });
+
+        string pieces;
+        {
+            JsonWriter writer(pieces);
+            writer.startArray();
+            writer.writeInt(10);
+            writer.writeString("Mario");
+            writer.startArray();
+            writer.endArray();
+            writer.startObject();
+            writer.key("width");
+            writer.writeInt(10);
+            writer.endObject();
+            writer.endArray();
+        }
+
+        stringstream stream;
+        stream << json;
+
+        TestAPI::ASSERT(
+            (pieces == json.toString()) &&
+            (stream.str() == json.toString()) &&
+            (JsonWriter::measure(json) == json.toString().size())
         );
     }
 
@@ -257,9 +1388,8 @@ int main() {
      */
     {
         TestAPI::TEST("ERROR HANDLING");
-        Json json = Json::fromString("[10, 230, \"Mario\"34.760000, true, false, null]");
-
-        const auto& diagnostics = json.Diagnostics();
+        vector<string> diagnostics;
+        Json json = Json::fromString("[10, 230, \"Mario\"34.760000, true, false, null]", diagnostics);
 
         for(const auto& diagnostic : diagnostics)
             cout << diagnostic << '\n';
@@ -0,0 +1,3 @@
+@echo off
+
+g++ -std=c++17 -O2 Json\\Json.cpp Json\\AccountingResource.cpp Json\\JsonBinary.cpp Json\\JsonCursor.cpp Json\\JsonDocument.cpp Json\\JsonPath.cpp Json\\JsonPushParser.cpp Json\\JsonSchema.cpp Json\\JsonSnapshot.cpp Json\\JsonWriter.cpp Json\\MappedFile.cpp Json\\ParseStats.cpp Json\\StructuralIndex.cpp Json\\ThreadPool.cpp Bench\\Corpus.cpp Bench\\bench.cpp -o bin\\bench && bin\\bench.exe %*
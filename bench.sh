@@ -0,0 +1,10 @@
+#!/bin/sh
+# Builds and runs the benchmarks, a json line per corpus goes to stdout:
+#   ./bench.sh [--size MB] [--repeat N] [--lookups N] [corpus...] > results.jsonl
+# The lines are labelled with the current git revision
+cd "$(dirname "$0")" || exit 1
+mkdir -p bin
+
+REVISION=$(git rev-parse --short HEAD 2>/dev/null || echo local)
+
+g++ -std=c++17 -O2 -pthread Json/*.cpp Bench/Corpus.cpp Bench/bench.cpp -o bin/bench && bin/bench --revision "$REVISION" "$@"
@@ -1,6 +1,6 @@
 @echo off
 
-cls && g++ Json\\Json.cpp Console\\Console.cpp Test\\Test.cpp Test\\app.cpp -o bin\\app && bin\\app.exe
+cls && g++ Json\\Json.cpp Json\\AccountingResource.cpp Json\\JsonBinary.cpp Json\\JsonCursor.cpp Json\\JsonDocument.cpp Json\\JsonPath.cpp Json\\JsonPushParser.cpp Json\\JsonSchema.cpp Json\\JsonSnapshot.cpp Json\\JsonWriter.cpp Json\\MappedFile.cpp Json\\ParseStats.cpp Json\\StructuralIndex.cpp Json\\ThreadPool.cpp Console\\Console.cpp Test\\Test.cpp Test\\app.cpp -o bin\\app && bin\\app.exe
 
 echo.
 pause
\ No newline at end of file
@@ -0,0 +1,6 @@
+#!/bin/sh
+# Builds and runs the tests (run.cmd on Windows)
+cd "$(dirname "$0")" || exit 1
+mkdir -p bin
+
+g++ -std=c++17 -pthread Json/*.cpp Console/Console.cpp Test/Test.cpp Test/app.cpp -o bin/app && bin/app